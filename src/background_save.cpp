@@ -0,0 +1,234 @@
+#include "background_save.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+#if defined(_WIN32) && !defined(_MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+#include "filesystem.h"
+#include "output.h"
+#include "translations.h"
+
+namespace
+{
+
+thread_local bool on_writer_thread = false;
+// Only used on the main thread.
+bool is_collecting = false;
+
+struct save_job {
+    std::string path;
+    std::function<void()> run;
+};
+
+class save_writer
+{
+    public:
+        ~save_writer() {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                stopping = true;
+            }
+            wakeup.notify_all();
+            // The thread finishes the queued jobs before it stops.
+            if( thread.joinable() ) {
+                thread.join();
+            }
+        }
+
+        void enqueue( save_job job ) {
+            std::lock_guard<std::mutex> lock( mutex );
+            if( !thread.joinable() ) {
+                thread = std::thread( [this]() {
+                    work();
+                } );
+            }
+            pending[job.path]++;
+            queue.push_back( std::move( job ) );
+            wakeup.notify_all();
+        }
+
+        void wait_for( const std::string &path ) {
+            std::unique_lock<std::mutex> lock( mutex );
+            done.wait( lock, [this, &path]() {
+                return pending.count( path ) == 0;
+            } );
+        }
+
+        /** Waits for all jobs, returns the path and error message of the failed ones. */
+        std::vector<std::pair<std::string, std::string>> wait() {
+            std::unique_lock<std::mutex> lock( mutex );
+            done.wait( lock, [this]() {
+                return pending.empty();
+            } );
+            std::vector<std::pair<std::string, std::string>> result;
+            result.swap( errors );
+            return result;
+        }
+
+        int failures() {
+            std::lock_guard<std::mutex> lock( mutex );
+            return failure_count;
+        }
+
+    private:
+        void work() {
+            on_writer_thread = true;
+            for( ;; ) {
+                save_job job;
+                {
+                    std::unique_lock<std::mutex> lock( mutex );
+                    wakeup.wait( lock, [this]() {
+                        return stopping || !queue.empty();
+                    } );
+                    if( queue.empty() ) {
+                        return;
+                    }
+                    job = std::move( queue.front() );
+                    queue.pop_front();
+                }
+
+                std::string error;
+                try {
+                    job.run();
+                } catch( const std::exception &err ) {
+                    error = err.what();
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock( mutex );
+                    if( !error.empty() ) {
+                        errors.emplace_back( job.path, error );
+                        failure_count++;
+                    }
+                    const auto iter = pending.find( job.path );
+                    if( --iter->second == 0 ) {
+                        pending.erase( iter );
+                    }
+                }
+                done.notify_all();
+            }
+        }
+
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::condition_variable done;
+        std::deque<save_job> queue;
+        /** Number of queued or running jobs for each path. */
+        std::map<std::string, int> pending;
+        std::vector<std::pair<std::string, std::string>> errors;
+        int failure_count = 0;
+        bool stopping = false;
+};
+
+save_writer &get_writer()
+{
+    static save_writer writer;
+    return writer;
+}
+
+} // namespace
+
+bool background_save::flush_to_disk( std::FILE *const file )
+{
+    if( std::fflush( file ) != 0 ) {
+        return false;
+    }
+#if defined(_WIN32)
+    return _commit( _fileno( file ) ) == 0;
+#else
+    return fsync( fileno( file ) ) == 0;
+#endif
+}
+
+void background_save::write_synced( const std::string &path, const std::string &data )
+{
+    const std::string temp_path = path + ".temp";
+    std::FILE *const file = std::fopen( temp_path.c_str(), "wb" );
+    if( file == nullptr ) {
+        throw std::runtime_error( "opening file failed" );
+    }
+    bool written = std::fwrite( data.data(), 1, data.size(), file ) == data.size() &&
+                   flush_to_disk( file );
+    written = std::fclose( file ) == 0 && written;
+    if( !written ) {
+        remove_file( temp_path );
+        throw std::runtime_error( "writing to file failed" );
+    }
+    if( !rename_file( temp_path, path ) ) {
+        // Leave the temp path, so the user can move it if possible.
+        throw std::runtime_error( "moving temporary file \"" + temp_path + "\" failed" );
+    }
+}
+
+void background_save::begin()
+{
+    is_collecting = true;
+}
+
+void background_save::end()
+{
+    is_collecting = false;
+}
+
+bool background_save::collecting()
+{
+    return !on_writer_thread && is_collecting;
+}
+
+void background_save::enqueue( const std::string &path, std::function<void()> job )
+{
+    get_writer().enqueue( save_job{ path, std::move( job ) } );
+}
+
+void background_save::enqueue_file( const std::string &path, std::string data )
+{
+    // Copies of the job share the data.
+    const auto shared_data = std::make_shared<std::string>( std::move( data ) );
+    enqueue( path, [path, shared_data]() {
+        write_synced( path, *shared_data );
+    } );
+}
+
+void background_save::wait_for( const std::string &path )
+{
+    // Jobs on the writer thread run in order, anything they read is already written.
+    if( on_writer_thread ) {
+        return;
+    }
+    get_writer().wait_for( path );
+}
+
+bool background_save::wait()
+{
+    if( on_writer_thread ) {
+        return true;
+    }
+    const auto errors = get_writer().wait();
+    for( const auto &error : errors ) {
+        popup( _( "Failed to save \"%1$s\": %2$s" ), error.first, error.second );
+    }
+    return errors.empty();
+}
+
+int background_save::failures()
+{
+    return get_writer().failures();
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef BACKGROUND_SAVE_H
+#define BACKGROUND_SAVE_H
+
+#include <cstdio>
+#include <functional>
+#include <string>
+
+/**
+ * Writes the files of a save on a background thread, so the game only has to wait until
+ * everything has been serialized into memory.
+ *
+ * Between @ref begin and @ref end, @ref write_to_file serializes into memory and hands
+ * the data to the writer thread instead of writing the file. The writer thread handles
+ * one file after the other in the order they were queued. Each file is written to a
+ * temporary file and synced to disk, then it replaces the old file by renaming. An
+ * interrupted save leaves the old file intact.
+ *
+ * Reading a file with @ref read_from_file waits until the queued writes of that file are
+ * done. Everything else that touches saved files has to call @ref wait first.
+ *
+ * The thread also reads saved map data ahead of time for @ref mapbuffer::prefetch, queued
+ * like the writes, so it never sees a file that is only partially written.
+ */
+namespace background_save
+{
+
+/** Starts queuing the files that are written. */
+void begin();
+/** Stops queuing, further files are written directly again. The queued ones are still written. */
+void end();
+/** Whether files written on the calling thread are queued right now. */
+bool collecting();
+
+/**
+ * Runs @p job on the writer thread, after all jobs queued before it.
+ * @p path is the file the job writes, @ref wait_for waits for it.
+ * If the job throws, the error is reported by the next @ref wait.
+ */
+void enqueue( const std::string &path, std::function<void()> job );
+/** Queues writing @p data to @p path. */
+void enqueue_file( const std::string &path, std::string data );
+/**
+ * Writes @p data to a temporary file and syncs it to disk, then it replaces @p path.
+ * Like ofstream_wrapper, but a crash at any point leaves either the old or the new file.
+ * Throws std::exception if anything fails. Used by the writer thread for the queued files.
+ */
+void write_synced( const std::string &path, const std::string &data );
+/** Flushes @p file and waits until its data is on the disk, returns false if that failed. */
+bool flush_to_disk( std::FILE *file );
+
+/** Waits until the queued jobs for @p path are done. */
+void wait_for( const std::string &path );
+/**
+ * Waits until all queued jobs are done and shows a popup for each one that failed
+ * since the last call.
+ * @return false if any job failed.
+ */
+bool wait();
+
+/**
+ * Number of jobs that failed so far, only complete after @ref wait.
+ * Whatever was skipped as unchanged since a write that failed has to be written again.
+ */
+int failures();
+
+} // namespace background_save
+
+#endif // BACKGROUND_SAVE_H
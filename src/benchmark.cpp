@@ -0,0 +1,117 @@
+#include "benchmark.h"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "avatar.h"
+#include "game.h"
+#include "get_version.h"
+#include "json.h"
+#include "pldata.h"
+#include "profiler.h"
+#include "type_id.h"
+#include "worldfactory.h"
+
+namespace
+{
+
+// The phases of game::do_turn that always show up in the report, even if they did not run.
+const std::array<const char *, 8> turn_phases = {{
+        "game::do_turn",
+        "map::vehmove",
+        "map::process_fields",
+        "map::process_active_items",
+        "sounds::process_sounds",
+        "game::monmove",
+        "game::overmap_npc_move",
+        "game::mon_info_update",
+    }
+};
+
+double ns_to_ms( const int64_t ns )
+{
+    return ns / 1000000.0;
+}
+
+void write_report( std::ostream &out, const int turns, const int64_t wall_ns )
+{
+    JsonOut jsout( out, true );
+    jsout.start_object();
+    jsout.member( "version", std::string( getVersionString() ) );
+    jsout.member( "turns", turns );
+    jsout.member( "wall_ms", ns_to_ms( wall_ns ) );
+    jsout.member( "turn_ms", turns > 0 ? ns_to_ms( wall_ns ) / turns : 0.0 );
+    jsout.member( "zones" );
+    jsout.start_object();
+    for( const profiler::zone *z : profiler::all_zones() ) {
+        jsout.member( z->name() );
+        jsout.start_object();
+        jsout.member( "calls", z->calls() );
+        jsout.member( "total_ms", ns_to_ms( z->total_ns() ) );
+        jsout.member( "mean_ms", z->calls() > 0 ? ns_to_ms( z->total_ns() ) / z->calls() : 0.0 );
+        jsout.member( "p50_ms", ns_to_ms( z->percentile( 50 ) ) );
+        jsout.member( "p99_ms", ns_to_ms( z->percentile( 99 ) ) );
+        jsout.member( "max_ms", ns_to_ms( z->max_ns() ) );
+        jsout.end_object();
+    }
+    jsout.end_object();
+    jsout.end_object();
+    out << std::endl;
+}
+
+} // namespace
+
+bool benchmark::run_turns( const int turns, std::ostream &out )
+{
+    world_generator->set_active_world( nullptr );
+    world_generator->init();
+    const std::vector<mod_id> mods_empty;
+    WORLDPTR bench_world = world_generator->make_new_world( mods_empty );
+    if( bench_world == nullptr ) {
+        std::cerr << "Could not create the benchmark world" << std::endl;
+        return false;
+    }
+    world_generator->set_active_world( bench_world );
+    const std::string world_name = bench_world->world_name;
+
+    for( const char *name : turn_phases ) {
+        profiler::get_zone( name );
+    }
+
+    int turns_done = 0;
+    int64_t wall_ns = 0;
+    try {
+        g->setup();
+        if( !g->u.create( PLTYPE_NOW ) || !g->start_game() ) {
+            std::cerr << "Could not start a game in the benchmark world" << std::endl;
+        } else {
+            profiler::reset();
+            profiler::set_enabled( true );
+            const int64_t start_ns = profiler::now_ns();
+            for( ; turns_done < turns; turns_done++ ) {
+                if( g->u.is_dead_state() ) {
+                    break;
+                }
+                // Nobody is at the keyboard, the avatar just lets its turns pass.
+                g->u.moves = 0;
+                if( g->do_turn() ) {
+                    break;
+                }
+            }
+            wall_ns = profiler::now_ns() - start_ns;
+            profiler::set_enabled( false );
+        }
+    } catch( const std::exception &err ) {
+        profiler::set_enabled( false );
+        std::cerr << "Error while running the benchmark: " << err.what() << std::endl;
+    }
+
+    world_generator->delete_world( world_name, true );
+
+    write_report( out, turns_done, wall_ns );
+    return turns_done == turns;
+}
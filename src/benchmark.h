@@ -0,0 +1,25 @@
+#pragma once
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <iosfwd>
+
+/**
+ * Headless benchmark of the turn loop, see the `--bench-turns` command line argument.
+ * The timings come from the profiling zones (see profiler.h) entered during the run.
+ */
+namespace benchmark
+{
+
+/**
+ * Creates a throwaway world with the core data only, starts a "play now" character in it
+ * and calls @ref game::do_turn @p turns times without waiting for input.
+ * The timings of all profiling zones are written as JSON to @p out.
+ * The random number generator must already be seeded for the run to be reproducible.
+ * @return Whether all turns could be run.
+ */
+bool run_turns( int turns, std::ostream &out );
+
+} // namespace benchmark
+
+#endif // BENCHMARK_H
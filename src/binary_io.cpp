@@ -0,0 +1,105 @@
+#include "binary_io.h"
+
+#include <climits>
+#include <stdexcept>
+
+void binary_out::write_varint( uint64_t value )
+{
+    while( value >= 0x80 ) {
+        data += static_cast<char>( ( value & 0x7f ) | 0x80 );
+        value >>= 7;
+    }
+    data += static_cast<char>( value );
+}
+
+void binary_out::write_int( const int value )
+{
+    const int64_t wide = value;
+    // Zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ... so small negative numbers stay short.
+    write_varint( ( static_cast<uint64_t>( wide ) << 1 ) ^ static_cast<uint64_t>( wide >> 63 ) );
+}
+
+void binary_out::write_string( const std::string &value )
+{
+    write_varint( value.size() );
+    data += value;
+}
+
+void binary_out::write_id( const std::string &id )
+{
+    const auto inserted = id_indices.emplace( id, ids.size() );
+    if( inserted.second ) {
+        ids.push_back( id );
+    }
+    write_varint( inserted.first->second );
+}
+
+void binary_out::finish( std::string &out ) const
+{
+    binary_out table;
+    table.write_varint( ids.size() );
+    for( const std::string &id : ids ) {
+        table.write_string( id );
+    }
+    out += table.data;
+    out += data;
+}
+
+binary_in::binary_in( const std::string &data, const size_t pos ) : data( data ), pos( pos )
+{
+    const uint64_t count = read_varint();
+    // Every id takes at least one byte, anything bigger can only come from corrupt data.
+    if( count > data.size() - this->pos ) {
+        throw std::runtime_error( "binary data has an invalid id table" );
+    }
+    ids.reserve( count );
+    for( uint64_t i = 0; i < count; i++ ) {
+        ids.push_back( read_string() );
+    }
+}
+
+uint64_t binary_in::read_varint()
+{
+    uint64_t value = 0;
+    for( int shift = 0; shift < 64; shift += 7 ) {
+        if( pos >= data.size() ) {
+            throw std::runtime_error( "unexpected end of binary data" );
+        }
+        const unsigned char byte = data[pos++];
+        value |= static_cast<uint64_t>( byte & 0x7f ) << shift;
+        if( ( byte & 0x80 ) == 0 ) {
+            return value;
+        }
+    }
+    throw std::runtime_error( "binary data has an invalid number" );
+}
+
+int binary_in::read_int()
+{
+    const uint64_t raw = read_varint();
+    const int64_t value = static_cast<int64_t>( raw >> 1 ) ^ -static_cast<int64_t>( raw & 1 );
+    if( value < INT_MIN || value > INT_MAX ) {
+        throw std::runtime_error( "binary data has a number out of range" );
+    }
+    return static_cast<int>( value );
+}
+
+std::string binary_in::read_string()
+{
+    const uint64_t size = read_varint();
+    if( size > data.size() - pos ) {
+        throw std::runtime_error( "unexpected end of binary data" );
+    }
+    std::string result = data.substr( pos, size );
+    pos += size;
+    return result;
+}
+
+const std::string &binary_in::read_id()
+{
+    const uint64_t index = read_varint();
+    if( index >= ids.size() ) {
+        throw std::runtime_error( "binary data refers to an unknown id" );
+    }
+    return ids[index];
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Writes a compact binary encoding: unsigned numbers as little endian base 128 varints,
+ * signed numbers zigzag encoded into them.
+ * Ids and other strings that repeat a lot are written as index into a table of all the
+ * distinct ones, @ref finish puts that table in front of the data.
+ */
+class binary_out
+{
+    public:
+        void write_varint( uint64_t value );
+        void write_int( int value );
+        void write_string( const std::string &value );
+        /** Writes @p id as index into the table of ids. */
+        void write_id( const std::string &id );
+
+        /** Appends the table of ids followed by all data written so far to @p out. */
+        void finish( std::string &out ) const;
+
+    private:
+        std::string data;
+        std::vector<std::string> ids;
+        std::unordered_map<std::string, uint64_t> id_indices;
+};
+
+/**
+ * Reads data written by @ref binary_out.
+ * All functions throw std::runtime_error if the data is malformed.
+ */
+class binary_in
+{
+    public:
+        /** Reads the table of ids that starts at @p pos in @p data, which must outlive this. */
+        binary_in( const std::string &data, size_t pos );
+
+        uint64_t read_varint();
+        int read_int();
+        std::string read_string();
+        const std::string &read_id();
+
+    private:
+        const std::string &data;
+        size_t pos;
+        std::vector<std::string> ids;
+};
+
+#endif // BINARY_IO_H
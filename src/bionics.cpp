@@ -42,6 +42,7 @@
 #include "player.h"
 #include "projectile.h"
 #include "rng.h"
+#include "sight_cache.h"
 #include "sounds.h"
 #include "string_formatter.h"
 #include "translations.h"
@@ -895,6 +896,8 @@ bool Character::activate_bionic( int b, bool eff_only )
     if( !bio.info().fake_item.empty() ) {
         invalidate_crafting_inventory();
     }
+    // Cloaks and sight bionics change who sees whom.
+    g->creature_sight->forget( *this );
 
     return true;
 }
@@ -971,6 +974,8 @@ bool Character::deactivate_bionic( int b, bool eff_only )
     if( !bio.info().fake_item.empty() ) {
         invalidate_crafting_inventory();
     }
+    // Cloaks and sight bionics change who sees whom.
+    g->creature_sight->forget( *this );
 
     return true;
 }
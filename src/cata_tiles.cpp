@@ -37,6 +37,7 @@
 #include "path_info.h"
 #include "player.h"
 #include "pixel_minimap.h"
+#include "profiler.h"
 #include "rect_range.h"
 #include "sdl_utils.h"
 #include "sdl_wrappers.h"
@@ -994,6 +995,7 @@ void cata_tiles::draw( const point &dest, const tripoint &center, int width, int
     if( !g ) {
         return;
     }
+    CATA_PROFILE_ZONE( "cata_tiles::draw" );
 
     {
         //set clipping to prevent drawing over stuff we shouldn't
@@ -11,6 +11,7 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "background_save.h"
 #include "debug.h"
 #include "filesystem.h"
 #include "json.h"
@@ -353,6 +354,17 @@ float multi_lerp( const std::vector<std::pair<float, float>> &points, float x )
 
 void write_to_file( const std::string &path, const std::function<void( std::ostream & )> &writer )
 {
+    if( background_save::collecting() ) {
+        std::ostringstream fout;
+        writer( fout );
+        if( fout.fail() ) {
+            throw std::runtime_error( "writing to file failed" );
+        }
+        background_save::enqueue_file( path, fout.str() );
+        return;
+    }
+    // An older version of the file that is still queued must not replace this one later.
+    background_save::wait_for( path );
     // Any of the below may throw. ofstream_wrapper will clean up the temporary path on its own.
     ofstream_wrapper fout( path, std::ios::binary );
     writer( fout.stream() );
@@ -419,6 +431,7 @@ std::istream &safe_getline( std::istream &ins, std::string &str )
 
 bool read_from_file( const std::string &path, const std::function<void( std::istream & )> &reader )
 {
+    background_save::wait_for( path );
     try {
         std::ifstream fin( path, std::ios::binary );
         if( !fin ) {
@@ -457,6 +470,7 @@ bool read_from_file_optional( const std::string &path,
     // Note: slight race condition here, but we'll ignore it. Worst case: the file
     // exists and got removed before reading it -> reading fails with a message
     // Or file does not exists, than everything works fine because it's optional anyway.
+    background_save::wait_for( path );
     return file_exist( path ) && read_from_file( path, reader );
 }
 
@@ -525,8 +539,7 @@ std::string serialize_wrapper( const std::function<void( JsonOut & )> &callback
 
 void deserialize_wrapper( const std::function<void( JsonIn & )> &callback, const std::string &data )
 {
-    std::istringstream buffer( data );
-    JsonIn jsin( buffer );
+    JsonIn jsin( data );
     callback( jsin );
 }
 
@@ -23,6 +23,7 @@
 #include "output.h"
 #include "projectile.h"
 #include "rng.h"
+#include "sight_cache.h"
 #include "translations.h"
 #include "vehicle.h"
 #include "vpart_position.h"
@@ -185,7 +186,21 @@ bool Creature::sees( const Creature &critter ) const
     if( &critter == this ) {
         return true;
     }
+    // What the avatar sees changes with each of their actions, the cache is for
+    // the monsters and NPCs acting in game::monmove.
+    if( is_avatar() ) {
+        return sees_uncached( critter );
+    }
+    if( const cata::optional<bool> cached = g->creature_sight->find( *this, critter ) ) {
+        return *cached;
+    }
+    const bool seen = sees_uncached( critter );
+    g->creature_sight->store( *this, critter, seen );
+    return seen;
+}
 
+bool Creature::sees_uncached( const Creature &critter ) const
+{
     if( critter.is_hallucination() ) {
         // hallucinations are imaginations of the player character, npcs or monsters don't hallucinate.
         // Invisible hallucinations would be pretty useless (nobody would see them at all), therefor
@@ -1019,6 +1034,8 @@ void Creature::add_effect( const efftype_id &eff_id, const time_duration &dur, b
             e.set_intensity( e.get_max_intensity() );
         }
         ( *effects )[eff_id][bp] = e;
+        // It may blind this creature or make it invisible.
+        g->creature_sight->forget( *this );
         if( Character *ch = as_character() ) {
             g->events().send<event_type::character_gains_effect>( ch->getID(), eff_id );
             if( is_player() && !type.get_apply_message().empty() ) {
@@ -1058,6 +1075,7 @@ void Creature::clear_effects()
         }
     }
     effects->clear();
+    g->creature_sight->forget( *this );
 }
 bool Creature::remove_effect( const efftype_id &eff_id, body_part bp )
 {
@@ -1090,6 +1108,7 @@ bool Creature::remove_effect( const efftype_id &eff_id, body_part bp )
             effects->erase( eff_id );
         }
     }
+    g->creature_sight->forget( *this );
     return true;
 }
 bool Creature::has_effect( const efftype_id &eff_id, body_part bp ) const
@@ -189,6 +189,10 @@ class Creature
         virtual bool sees( const Creature &critter ) const;
         virtual bool sees( const tripoint &t, bool is_avatar = false, int range_mod = 0 ) const;
         /*@}*/
+    protected:
+        /** @ref sees without looking at @ref sight_cache. */
+        bool sees_uncached( const Creature &critter ) const;
+    public:
 
         /**
          * How far the creature sees under the given light. Places outside this range can
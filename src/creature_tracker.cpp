@@ -1,10 +1,12 @@
 #include "creature_tracker.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <utility>
 
+#include "coordinate_conversions.h"
 #include "debug.h"
 #include "mongroup.h"
 #include "monster.h"
@@ -84,7 +86,7 @@ bool Creature_tracker::add( shared_ptr_fast<monster> critter_ptr )
     }
 
     monsters_list.emplace_back( critter_ptr );
-    monsters_by_location[critter.pos()] = critter_ptr;
+    set_location( critter.pos(), critter_ptr );
     add_to_faction_map( critter_ptr );
     return true;
 }
@@ -108,6 +110,79 @@ size_t Creature_tracker::size() const
     return monsters_list.size();
 }
 
+std::vector<monster *> Creature_tracker::creatures_in_rect( const tripoint &min,
+        const tripoint &max ) const
+{
+    std::vector<monster *> result;
+    const auto add_from = [&]( const std::vector<monster *> &critters ) {
+        for( monster *const critter : critters ) {
+            const tripoint &pos = critter->pos();
+            if( pos.x >= min.x && pos.x <= max.x && pos.y >= min.y && pos.y <= max.y &&
+                pos.z >= min.z && pos.z <= max.z && !critter->is_dead() ) {
+                result.push_back( critter );
+            }
+        }
+    };
+    const tripoint min_sm = ms_to_sm_copy( min );
+    const tripoint max_sm = ms_to_sm_copy( max );
+    const int64_t submaps_in_rect = static_cast<int64_t>( max_sm.x - min_sm.x + 1 ) *
+                                    ( max_sm.y - min_sm.y + 1 ) * ( max_sm.z - min_sm.z + 1 );
+    if( submaps_in_rect > static_cast<int64_t>( monsters_by_submap.size() ) ) {
+        // A big area (e.g. a loud sound), checking the occupied submaps is faster.
+        for( const auto &elem : monsters_by_submap ) {
+            add_from( elem.second );
+        }
+        return result;
+    }
+    for( int z = min_sm.z; z <= max_sm.z; ++z ) {
+        for( int x = min_sm.x; x <= max_sm.x; ++x ) {
+            for( int y = min_sm.y; y <= max_sm.y; ++y ) {
+                const auto iter = monsters_by_submap.find( tripoint( x, y, z ) );
+                if( iter != monsters_by_submap.end() ) {
+                    add_from( iter->second );
+                }
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<monster *> Creature_tracker::creatures_in_radius( const tripoint &center,
+        const int radius ) const
+{
+    if( radius < 0 ) {
+        return {};
+    }
+    const tripoint offset( radius, radius, radius );
+    return creatures_in_rect( center - offset, center + offset );
+}
+
+void Creature_tracker::set_location( const tripoint &pos, const shared_ptr_fast<monster> &critter )
+{
+    shared_ptr_fast<monster> &entry = monsters_by_location[pos];
+    if( entry == critter ) {
+        return;
+    }
+    if( entry ) {
+        std::vector<monster *> &others = monsters_by_submap[ms_to_sm_copy( pos )];
+        others.erase( std::find( others.begin(), others.end(), entry.get() ) );
+    }
+    entry = critter;
+    monsters_by_submap[ms_to_sm_copy( pos )].push_back( critter.get() );
+}
+
+void Creature_tracker::erase_location( const
+                                       std::unordered_map<tripoint, shared_ptr_fast<monster>>::iterator iter )
+{
+    const auto sm_iter = monsters_by_submap.find( ms_to_sm_copy( iter->first ) );
+    std::vector<monster *> &critters = sm_iter->second;
+    critters.erase( std::find( critters.begin(), critters.end(), iter->second.get() ) );
+    if( critters.empty() ) {
+        monsters_by_submap.erase( sm_iter );
+    }
+    monsters_by_location.erase( iter );
+}
+
 bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_pos )
 {
     if( critter.is_dead() ) {
@@ -134,8 +209,11 @@ bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_p
         return ptr.get() == &critter;
     } );
     if( iter != monsters_list.end() ) {
-        monsters_by_location.erase( critter.pos() );
-        monsters_by_location[new_pos] = *iter;
+        const auto old_iter = monsters_by_location.find( critter.pos() );
+        if( old_iter != monsters_by_location.end() ) {
+            erase_location( old_iter );
+        }
+        set_location( new_pos, *iter );
         return true;
     } else {
         const tripoint &old_pos = critter.pos();
@@ -154,7 +232,7 @@ void Creature_tracker::remove_from_location_map( const monster &critter )
 {
     const auto pos_iter = monsters_by_location.find( critter.pos() );
     if( pos_iter != monsters_by_location.end() && pos_iter->second.get() == &critter ) {
-        monsters_by_location.erase( pos_iter );
+        erase_location( pos_iter );
         return;
     }
 
@@ -165,7 +243,7 @@ void Creature_tracker::remove_from_location_map( const monster &critter )
         return v.second.get() == &critter;
     } );
     if( iter != monsters_by_location.end() ) {
-        monsters_by_location.erase( iter );
+        erase_location( iter );
     }
 }
 
@@ -198,6 +276,7 @@ void Creature_tracker::clear()
 {
     monsters_list.clear();
     monsters_by_location.clear();
+    monsters_by_submap.clear();
     monster_faction_map_.clear();
     removed_.clear();
 }
@@ -205,9 +284,10 @@ void Creature_tracker::clear()
 void Creature_tracker::rebuild_cache()
 {
     monsters_by_location.clear();
+    monsters_by_submap.clear();
     monster_faction_map_.clear();
     for( const shared_ptr_fast<monster> &mon_ptr : monsters_list ) {
-        monsters_by_location[mon_ptr->pos()] = mon_ptr;
+        set_location( mon_ptr->pos(), mon_ptr );
         add_to_faction_map( mon_ptr );
     }
 }
@@ -226,13 +306,13 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     shared_ptr_fast<monster> first_ptr;
     if( first_iter != monsters_by_location.end() ) {
         first_ptr = first_iter->second;
-        monsters_by_location.erase( first_iter );
+        erase_location( first_iter );
     }
 
     shared_ptr_fast<monster> second_ptr;
     if( second_iter != monsters_by_location.end() ) {
         second_ptr = second_iter->second;
-        monsters_by_location.erase( second_iter );
+        erase_location( second_iter );
     }
     // implied: (first_ptr != second_ptr) or (first_ptr == nullptr && second_ptr == nullptr)
 
@@ -242,10 +322,10 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
 
     // If the pointers have been taken out of the list, put them back in.
     if( first_ptr ) {
-        monsters_by_location[first.pos()] = first_ptr;
+        set_location( first.pos(), first_ptr );
     }
     if( second_ptr ) {
-        monsters_by_location[second.pos()] = second_ptr;
+        set_location( second.pos(), second_ptr );
     }
 }
 
@@ -66,6 +66,18 @@ class Creature_tracker
          */
         bool add( shared_ptr_fast<monster> critter );
         size_t size() const;
+        /**
+         * Returns the monsters whose position is inside the box from @p min to @p max,
+         * both inclusive. Dead monsters are ignored.
+         * This only looks at the submaps the box covers, not at all monsters.
+         */
+        std::vector<monster *> creatures_in_rect( const tripoint &min, const tripoint &max ) const;
+        /**
+         * Returns the monsters that are at most @p radius away from @p center along each
+         * axis, which includes all monsters within that @ref rl_dist.
+         * Dead monsters are ignored.
+         */
+        std::vector<monster *> creatures_in_radius( const tripoint &center, int radius ) const;
         /** Updates the position of the given monster to the given point. Returns whether the operation
          *  was successful. */
         bool update_pos( const monster &critter, const tripoint &new_pos );
@@ -94,6 +106,15 @@ class Creature_tracker
     private:
         std::vector<shared_ptr_fast<monster>> monsters_list;
         std::unordered_map<tripoint, shared_ptr_fast<monster>> monsters_by_location;
+        /**
+         * The monsters of @ref monsters_by_location, grouped by the submap their location is in
+         * (on the same z-level). Each entry is kept up to date together with that map.
+         */
+        std::unordered_map<tripoint, std::vector<monster *>> monsters_by_submap;
+        /** Adds the monster to @ref monsters_by_location and @ref monsters_by_submap. */
+        void set_location( const tripoint &pos, const shared_ptr_fast<monster> &critter );
+        /** Removes the entry from @ref monsters_by_location and @ref monsters_by_submap. */
+        void erase_location( std::unordered_map<tripoint, shared_ptr_fast<monster>>::iterator iter );
         /** Remove the monsters entry in @ref monsters_by_location */
         void remove_from_location_map( const monster &critter );
 };
@@ -0,0 +1,114 @@
+#include "data_snapshot.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+#include "cata_utility.h"
+#include "filesystem.h"
+#include "get_version.h"
+#include "path_info.h"
+
+namespace
+{
+
+// Keys of the most recently validated data, a few of them so switching worlds doesn't
+// throw away the others.
+const size_t max_validated_keys = 32;
+
+// FNV-1a, it only has to notice changes, not resist tampering.
+uint64_t hash_bytes( uint64_t hash, const std::string &bytes )
+{
+    for( const char c : bytes ) {
+        hash ^= static_cast<unsigned char>( c );
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string validated_path()
+{
+    return PATH_INFO::datacachedir() + "validated.txt";
+}
+
+std::vector<std::string> read_validated_keys()
+{
+    std::vector<std::string> keys;
+    std::istringstream lines( data_snapshot::read_file( validated_path() ) );
+    std::string line;
+    while( std::getline( lines, line ) ) {
+        if( !line.empty() ) {
+            keys.push_back( line );
+        }
+    }
+    return keys;
+}
+
+} // namespace
+
+uint64_t data_snapshot::content_hash( const std::string &content )
+{
+    return hash_bytes( 0xcbf29ce484222325ULL, content );
+}
+
+std::string data_snapshot::content_key( const std::vector<std::string> &files,
+                                        const std::vector<uint64_t> &content_hashes )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for( size_t i = 0; i < files.size(); i++ ) {
+        std::ostringstream entry;
+        entry << files[i] << ' ' << std::hex << content_hashes[i] << '\n';
+        hash = hash_bytes( hash, entry.str() );
+    }
+    std::ostringstream key;
+    key << files.size() << '-' << std::hex << hash;
+    return key.str();
+}
+
+std::string data_snapshot::validation_key( const std::vector<std::string> &content_keys )
+{
+    // The checks are part of the game, a different version may check differently.
+    uint64_t hash = hash_bytes( 0xcbf29ce484222325ULL, getVersionString() );
+    for( const std::string &key : content_keys ) {
+        hash = hash_bytes( hash, key + '\n' );
+    }
+    std::ostringstream key;
+    key << std::hex << hash;
+    return key.str();
+}
+
+bool data_snapshot::was_validated( const std::string &key )
+{
+    const std::vector<std::string> keys = read_validated_keys();
+    return std::find( keys.begin(), keys.end(), key ) != keys.end();
+}
+
+void data_snapshot::mark_validated( const std::string &key )
+{
+    std::vector<std::string> keys = read_validated_keys();
+    keys.erase( std::remove( keys.begin(), keys.end(), key ), keys.end() );
+    keys.push_back( key );
+    if( keys.size() > max_validated_keys ) {
+        keys.erase( keys.begin(), keys.end() - max_validated_keys );
+    }
+    if( !assure_dir_exist( PATH_INFO::datacachedir() ) ) {
+        return;
+    }
+    // Failing only means the checks run again on the next start.
+    write_to_file( validated_path(), [&keys]( std::ostream & fout ) {
+        for( const std::string &k : keys ) {
+            fout << k << '\n';
+        }
+    }, nullptr );
+}
+
+std::string data_snapshot::read_file( const std::string &path )
+{
+    std::ifstream fin( path, std::ios::binary );
+    std::ostringstream data;
+    if( fin ) {
+        data << fin.rdbuf();
+    }
+    return data.str();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef DATA_SNAPSHOT_H
+#define DATA_SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Remembers which combinations of data (the core data, mods, sound packs) passed the
+ * consistency checks, so they are not repeated on every start. The data is identified by
+ * hashes of the contents of its JSON files, the cache lives in @ref PATH_INFO::datacachedir.
+ */
+namespace data_snapshot
+{
+
+/** Hash of the contents of one JSON file. Safe to call from any thread. */
+uint64_t content_hash( const std::string &content );
+/**
+ * Returns the key for the data in @p files, in load order. @p content_hashes are the
+ * @ref content_hash values of the files.
+ */
+std::string content_key( const std::vector<std::string> &files,
+                         const std::vector<uint64_t> &content_hashes );
+
+/**
+ * Returns the key for checking the consistency of the data loaded from the paths with
+ * @p content_keys in this version of the game.
+ */
+std::string validation_key( const std::vector<std::string> &content_keys );
+/** Whether the data with @p key passed the consistency checks before. */
+bool was_validated( const std::string &key );
+/** Remembers that the data with @p key passed the consistency checks. */
+void mark_validated( const std::string &key );
+
+/**
+ * Reads the whole file at @p path, an empty string if it can't be read.
+ * Safe to call from any thread.
+ */
+std::string read_file( const std::string &path );
+
+} // namespace data_snapshot
+
+#endif // DATA_SNAPSHOT_H
@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <chrono>
+#include <exception>
 #include <vector>
 #include <array>
 #include <iomanip>
@@ -29,6 +30,7 @@
 #include "game.h"
 #include "game_inventory.h"
 #include "map_extras.h"
+#include "mapbuffer.h"
 #include "messages.h"
 #include "mission.h"
 #include "morale_types.h"
@@ -40,6 +42,8 @@
 #include "overmap_ui.h"
 #include "overmapbuffer.h"
 #include "player.h"
+#include "path_info.h"
+#include "profiler.h"
 #include "string_formatter.h"
 #include "string_input_popup.h"
 #include "ui.h"
@@ -162,9 +166,18 @@ enum debug_menu_index {
     DEBUG_LEARN_SPELLS,
     DEBUG_LEVEL_SPELLS,
     DEBUG_TEST_MAP_EXTRA_DISTRIBUTION,
-    DEBUG_NESTED_MAPGEN
+    DEBUG_NESTED_MAPGEN,
+    DEBUG_PROFILER_OVERLAY,
+    DEBUG_PROFILER_RECORD,
+    DEBUG_PROFILER_EXPORT,
+    DEBUG_CONVERT_MAP_SAVES,
+    DEBUG_MAP_MEMORY
 };
 
+static bool show_profiler_overlay = false;
+// Whether the profiling zones record while the overlay is hidden, e.g. for an export.
+static bool record_profiler_zones = false;
+
 class mission_debug
 {
     private:
@@ -224,6 +237,11 @@ static int info_uilist( bool display_all_entries = true )
             { uilist_entry( DEBUG_DISPLAY_RADIATION, true, 'R', _( "Toggle display radiation" ) ) },
             { uilist_entry( DEBUG_SHOW_MUT_CAT, true, 'm', _( "Show mutation category levels" ) ) },
             { uilist_entry( DEBUG_BENCHMARK, true, 'b', _( "Draw benchmark (X seconds)" ) ) },
+            { uilist_entry( DEBUG_PROFILER_OVERLAY, true, 'p', _( "Toggle profiling zones overlay" ) ) },
+            { uilist_entry( DEBUG_PROFILER_RECORD, true, 'Z', _( "Toggle recording profiling zones" ) ) },
+            { uilist_entry( DEBUG_PROFILER_EXPORT, true, 'P', _( "Export profiling zones as Chrome trace" ) ) },
+            { uilist_entry( DEBUG_CONVERT_MAP_SAVES, true, 'F', _( "Convert saved map to the world's map save format" ) ) },
+            { uilist_entry( DEBUG_MAP_MEMORY, true, 'u', _( "Show memory used by the loaded map" ) ) },
             { uilist_entry( DEBUG_TRAIT_GROUP, true, 't', _( "Test trait group" ) ) },
             { uilist_entry( DEBUG_SHOW_MSG, true, 'd', _( "Show debug message" ) ) },
             { uilist_entry( DEBUG_CRASH_GAME, true, 'C', _( "Crash game (test crash handling)" ) ) },
@@ -1062,6 +1080,36 @@ void mission_debug::edit_mission( mission &m )
     }
 }
 
+void draw_profiler_overlay()
+{
+    if( !show_profiler_overlay ) {
+        return;
+    }
+    std::vector<const profiler::zone *> zones;
+    for( const profiler::zone *z : profiler::all_zones() ) {
+        if( z->calls() > 0 ) {
+            zones.push_back( z );
+        }
+    }
+    const int width = 50;
+    const int height = std::min<int>( zones.size() + 3, TERMY );
+    catacurses::window w = catacurses::newwin( height, width, point( TERMX - width, 0 ) );
+    werase( w );
+    draw_border( w );
+    mvwprintz( w, point( 1, 1 ), c_white, "%-28s %8s %8s", _( "zone" ), _( "p50 ms" ), _( "p99 ms" ) );
+    int line = 2;
+    for( const profiler::zone *z : zones ) {
+        if( line >= height - 1 ) {
+            break;
+        }
+        const double p50 = z->percentile( 50 ) / 1000000.0;
+        const double p99 = z->percentile( 99 ) / 1000000.0;
+        mvwprintz( w, point( 1, line++ ), p99 > 16.0 ? c_light_red : c_light_gray,
+                   "%-28.28s %8.2f %8.2f", z->name(), p50, p99 );
+    }
+    wrefresh( w );
+}
+
 void draw_benchmark( const int max_difference )
 {
     // call the draw procedure as many times as possible in max_difference milliseconds
@@ -1569,6 +1617,78 @@ void debug()
         }
         break;
 
+        case DEBUG_PROFILER_OVERLAY:
+            show_profiler_overlay = !show_profiler_overlay;
+            // Recording costs time and memory in every zone, it only runs while it is needed.
+            profiler::set_enabled( show_profiler_overlay || record_profiler_zones );
+            break;
+
+        case DEBUG_PROFILER_RECORD:
+            record_profiler_zones = !record_profiler_zones;
+            profiler::set_enabled( show_profiler_overlay || record_profiler_zones );
+            popup( record_profiler_zones ? _( "Recording profiling zones." ) :
+                   _( "Stopped recording profiling zones." ) );
+            break;
+
+        case DEBUG_PROFILER_EXPORT: {
+            const std::string path = PATH_INFO::config_dir() + "profile_trace.json";
+            if( !profiler::enabled() ) {
+                popup( _( "Profiling is off, turn on recording profiling zones or their overlay first." ) );
+            } else if( profiler::write_chrome_trace( path ) ) {
+                popup( _( "Profiling zones written to %s" ), path );
+            } else {
+                popup( _( "Failed to write the profiling zones to %s" ), path );
+            }
+        }
+        break;
+
+        case DEBUG_MAP_MEMORY: {
+            std::vector<mapbuffer::quad_memory> quads = MAPBUFFER.memory_usage();
+            size_t total = 0;
+            int dirty = 0;
+            for( const mapbuffer::quad_memory &quad : quads ) {
+                total += quad.bytes;
+                dirty += quad.dirty ? 1 : 0;
+            }
+            const auto describe = []( const mapbuffer::quad_memory & quad ) {
+                return string_format( "  %d,%d,%d: %.1f KiB%s\n", quad.om_addr.x, quad.om_addr.y,
+                                      quad.om_addr.z, quad.bytes / 1024.0, quad.dirty ? _( " (changed)" ) : "" );
+            };
+            const mapbuffer::save_report &last_save = MAPBUFFER.last_save();
+            std::string text = string_format(
+                                   _( "Loaded quads: %d, %d changed since they were saved\n"
+                                      "Estimated memory: %.1f MiB, budget: %d MiB\n"
+                                      "Last save: %d quads written (%.1f KiB), %d unchanged quads skipped\n\n"
+                                      "Next to be unloaded:\n" ),
+                                   quads.size(), dirty, total / ( 1024.0 * 1024.0 ),
+                                   get_option<int>( "MAP_MEMORY_BUDGET" ), last_save.quads_written,
+                                   last_save.bytes_written / 1024.0, last_save.quads_unchanged );
+            for( size_t i = 0; i < quads.size() && i < 10; i++ ) {
+                text += describe( quads[i] );
+            }
+            std::sort( quads.begin(), quads.end(), []( const mapbuffer::quad_memory & lhs,
+            const mapbuffer::quad_memory & rhs ) {
+                return lhs.bytes > rhs.bytes;
+            } );
+            text += _( "\nLargest:\n" );
+            for( size_t i = 0; i < quads.size() && i < 10; i++ ) {
+                text += describe( quads[i] );
+            }
+            popup( "%s", text );
+        }
+        break;
+
+        case DEBUG_CONVERT_MAP_SAVES: {
+            const bool binary = get_option<std::string>( "MAP_SAVE_FORMAT" ) == "binary";
+            try {
+                const int converted = MAPBUFFER.convert_saved_maps( binary );
+                popup( _( "Converted %d saved map quads." ), converted );
+            } catch( const std::exception &err ) {
+                popup( _( "Failed to convert the saved map: %s" ), err.what() );
+            }
+        }
+        break;
+
         case DEBUG_OM_TELEPORT:
             debug_menu::teleport_overmap();
             break;
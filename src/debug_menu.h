@@ -27,6 +27,8 @@ void wishmutate( player *p );
 void wishskill( player *p );
 void mutation_wish();
 void draw_benchmark( int max_difference );
+/** Draws rolling p50/p99 timings of the profiling zones if enabled through the debug menu. */
+void draw_profiler_overlay();
 
 void debug();
 
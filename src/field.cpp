@@ -141,6 +141,86 @@ field::field()
 {
 }
 
+field::field( const field &other )
+    : _displayed_field_type( fd_null )
+{
+    *this = other;
+}
+
+field &field::operator=( const field &other )
+{
+    if( this == &other ) {
+        return *this;
+    }
+    entry_block *dst = &_entries;
+    for( const entry_block *src = &other._entries; src != nullptr; src = src->next.get() ) {
+        dst->entries = src->entries;
+        dst->used = src->used;
+        if( src->next && !dst->next ) {
+            dst->next = std::make_unique<entry_block>();
+        } else if( !src->next ) {
+            dst->next.reset();
+        }
+        dst = dst->next.get();
+    }
+    _displayed_field_type = other._displayed_field_type;
+    return *this;
+}
+
+field::value_type &field::entry_at( int slot )
+{
+    entry_block *block = &_entries;
+    for( ; slot >= block_size; slot -= block_size ) {
+        block = block->next.get();
+    }
+    return block->entries[slot];
+}
+
+const field::value_type &field::entry_at( int slot ) const
+{
+    const entry_block *block = &_entries;
+    for( ; slot >= block_size; slot -= block_size ) {
+        block = block->next.get();
+    }
+    return block->entries[slot];
+}
+
+int field::next_slot( const int slot ) const
+{
+    const field_type_id *const after = slot < 0 ? nullptr : &entry_at( slot ).first;
+    int result = -1;
+    const field_type_id *result_type = nullptr;
+    int base = 0;
+    for( const entry_block *block = &_entries; block != nullptr; block = block->next.get() ) {
+        for( int i = 0; i < block_size; i++ ) {
+            if( !( block->used & ( 1 << i ) ) ) {
+                continue;
+            }
+            const field_type_id &type = block->entries[i].first;
+            if( ( after == nullptr || *after < type ) && ( result_type == nullptr || type < *result_type ) ) {
+                result = base + i;
+                result_type = &type;
+            }
+        }
+        base += block_size;
+    }
+    return result;
+}
+
+int field::find_slot( const field_type_id &type ) const
+{
+    int base = 0;
+    for( const entry_block *block = &_entries; block != nullptr; block = block->next.get() ) {
+        for( int i = 0; i < block_size; i++ ) {
+            if( ( block->used & ( 1 << i ) ) && block->entries[i].first == type ) {
+                return base + i;
+            }
+        }
+        base += block_size;
+    }
+    return -1;
+}
+
 /*
 Function: find_field
 Returns a field entry corresponding to the field_type_id parameter passed in. If no fields are found then returns NULL.
@@ -148,18 +228,18 @@ Good for checking for existence of a field: if(myfield.find_field(fd_fire)) woul
 */
 field_entry *field::find_field( const field_type_id &field_type_to_find )
 {
-    const auto it = _field_type_list.find( field_type_to_find );
-    if( it != _field_type_list.end() ) {
-        return &it->second;
+    const int slot = find_slot( field_type_to_find );
+    if( slot >= 0 ) {
+        return &entry_at( slot ).second;
     }
     return nullptr;
 }
 
 const field_entry *field::find_field_c( const field_type_id &field_type_to_find ) const
 {
-    const auto it = _field_type_list.find( field_type_to_find );
-    if( it != _field_type_list.end() ) {
-        return &it->second;
+    const int slot = find_slot( field_type_to_find );
+    if( slot >= 0 ) {
+        return &entry_at( slot ).second;
     }
     return nullptr;
 }
@@ -180,40 +260,66 @@ Intensity defaults to 1, and age to 0 (permanent) if not specified.
 bool field::add_field( const field_type_id &field_type_to_add, const int new_intensity,
                        const time_duration &new_age )
 {
-    auto it = _field_type_list.find( field_type_to_add );
+    field_entry *const existing = find_field( field_type_to_add );
     if( field_type_to_add.obj().priority >= _displayed_field_type.obj().priority ) {
         _displayed_field_type = field_type_to_add;
     }
-    if( it != _field_type_list.end() ) {
+    if( existing != nullptr ) {
         //Already exists, but lets update it. This is tentative.
-        it->second.set_field_intensity( it->second.get_field_intensity() + new_intensity );
+        existing->set_field_intensity( existing->get_field_intensity() + new_intensity );
         return false;
     }
-    _field_type_list[field_type_to_add] = field_entry( field_type_to_add, new_intensity, new_age );
+    // Take the first free slot, the ones in use must not move.
+    entry_block *block = &_entries;
+    while( block->used == ( 1 << block_size ) - 1 ) {
+        if( !block->next ) {
+            block->next = std::make_unique<entry_block>();
+        }
+        block = block->next.get();
+    }
+    int i = 0;
+    while( block->used & ( 1 << i ) ) {
+        i++;
+    }
+    block->entries[i] = value_type( field_type_to_add, field_entry( field_type_to_add, new_intensity,
+                                    new_age ) );
+    block->used |= 1 << i;
     return true;
 }
 
 bool field::remove_field( const field_type_id &field_to_remove )
 {
-    const auto it = _field_type_list.find( field_to_remove );
-    if( it == _field_type_list.end() ) {
+    const int slot = find_slot( field_to_remove );
+    if( slot < 0 ) {
         return false;
     }
-    remove_field( it );
+    remove_field( iterator( *this, slot ) );
     return true;
 }
 
-void field::remove_field( std::map<field_type_id, field_entry>::iterator const it )
+void field::remove_field( const iterator it )
 {
-    _field_type_list.erase( it );
-    if( _field_type_list.empty() ) {
-        _displayed_field_type = fd_null;
-    } else {
-        _displayed_field_type = fd_null;
-        for( auto &fld : _field_type_list ) {
-            if( fld.first.obj().priority >= _displayed_field_type.obj().priority ) {
-                _displayed_field_type = fld.first;
-            }
+    int slot = it.slot;
+    entry_block *block = &_entries;
+    for( ; slot >= block_size; slot -= block_size ) {
+        block = block->next.get();
+    }
+    block->used &= ~( 1 << slot );
+    block->entries[slot] = value_type();
+
+    // Drop the overflow blocks once they are all empty, no entry in them can be referenced anymore.
+    bool overflow_used = false;
+    for( const entry_block *b = _entries.next.get(); b != nullptr; b = b->next.get() ) {
+        overflow_used |= b->used != 0;
+    }
+    if( !overflow_used ) {
+        _entries.next.reset();
+    }
+
+    _displayed_field_type = fd_null;
+    for( auto &fld : *this ) {
+        if( fld.first.obj().priority >= _displayed_field_type.obj().priority ) {
+            _displayed_field_type = fld.first;
         }
     }
 }
@@ -224,27 +330,33 @@ Returns the number of fields existing on the current tile.
 */
 unsigned int field::field_count() const
 {
-    return _field_type_list.size();
+    unsigned int count = 0;
+    for( const entry_block *block = &_entries; block != nullptr; block = block->next.get() ) {
+        for( int i = 0; i < block_size; i++ ) {
+            count += ( block->used >> i ) & 1;
+        }
+    }
+    return count;
 }
 
-std::map<field_type_id, field_entry>::iterator field::begin()
+field::iterator field::begin()
 {
-    return _field_type_list.begin();
+    return iterator( *this, next_slot( -1 ) );
 }
 
-std::map<field_type_id, field_entry>::const_iterator field::begin() const
+field::const_iterator field::begin() const
 {
-    return _field_type_list.begin();
+    return const_iterator( *this, next_slot( -1 ) );
 }
 
-std::map<field_type_id, field_entry>::iterator field::end()
+field::iterator field::end()
 {
-    return _field_type_list.end();
+    return iterator( *this, -1 );
 }
 
-std::map<field_type_id, field_entry>::const_iterator field::end() const
+field::const_iterator field::end() const
 {
-    return _field_type_list.end();
+    return const_iterator( *this, -1 );
 }
 
 /*
@@ -264,7 +376,7 @@ description_affix field::displayed_description_affix() const
 int field::total_move_cost() const
 {
     int current_cost = 0;
-    for( auto &fld : _field_type_list ) {
+    for( auto &fld : *this ) {
         current_cost += fld.second.move_cost();
     }
     return current_cost;
@@ -2,8 +2,14 @@
 #ifndef FIELD_H
 #define FIELD_H
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "calendar.h"
 #include "color.h"
@@ -124,11 +130,70 @@ class field_entry
  * Use @ref find_field to get the field entry of a specific type, or iterate over
  * all entries via @ref begin and @ref end (allows range based iteration).
  * There is @ref displayed_field_type to specific which field should be drawn on the map.
+ *
+ * The first few entries are stored inline, further ones in blocks chained behind them,
+ * so most tiles never allocate. Entries never move while they exist: references and
+ * iterators stay valid when other entries are added or removed, and the iteration is
+ * ordered by field type, just like it would be for a std::map.
 */
 class field
 {
     public:
+        using value_type = std::pair<field_type_id, field_entry>;
+
+    private:
+        template<typename Field, typename Value>
+        class iterator_base
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = field::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Value *;
+                using reference = Value &;
+
+                iterator_base( Field &owner, const int slot ) : owner( &owner ), slot( slot ) {
+                }
+
+                reference operator*() const {
+                    return owner->entry_at( slot );
+                }
+                pointer operator->() const {
+                    return &owner->entry_at( slot );
+                }
+                iterator_base &operator++() {
+                    slot = owner->next_slot( slot );
+                    return *this;
+                }
+                iterator_base operator++( int ) {
+                    iterator_base old = *this;
+                    ++*this;
+                    return old;
+                }
+                bool operator==( const iterator_base &rhs ) const {
+                    return slot == rhs.slot;
+                }
+                bool operator!=( const iterator_base &rhs ) const {
+                    return slot != rhs.slot;
+                }
+
+            private:
+                friend class field;
+
+                Field *owner;
+                /** Index into the slots of @ref owner, -1 for the end. */
+                int slot;
+        };
+
+    public:
+        using iterator = iterator_base<field, value_type>;
+        using const_iterator = iterator_base<const field, const value_type>;
+
         field();
+        field( const field &other );
+        field( field && ) = default;
+        field &operator=( const field &other );
+        field &operator=( field && ) = default;
 
         /**
          * Returns a field entry corresponding to the field_type_id parameter passed in.
@@ -165,9 +230,10 @@ class field
         bool remove_field( const field_type_id &field_to_remove );
         /**
          * Make sure to decrement the field counter in the submap.
-         * Removes the field entry, the iterator must point into @ref _field_type_list and must be valid.
+         * Removes the field entry, the iterator must point into this field and must be valid.
+         * Other iterators stay valid, so `remove_field( it++ )` works while iterating.
          */
-        void remove_field( std::map<field_type_id, field_entry>::iterator );
+        void remove_field( iterator );
 
         // Returns the number of fields existing on the current tile.
         unsigned int field_count() const;
@@ -179,13 +245,13 @@ class field
 
         description_affix displayed_description_affix() const;
 
-        //Returns the vector iterator to begin searching through the list.
-        std::map<field_type_id, field_entry>::iterator begin();
-        std::map<field_type_id, field_entry>::const_iterator begin() const;
+        //Returns the iterator to begin searching through the list.
+        iterator begin();
+        const_iterator begin() const;
 
-        //Returns the vector iterator to end searching through the list.
-        std::map<field_type_id, field_entry>::iterator end();
-        std::map<field_type_id, field_entry>::const_iterator end() const;
+        //Returns the iterator to end searching through the list.
+        iterator end();
+        const_iterator end() const;
 
         /**
          * Returns the total move cost from all fields.
@@ -193,8 +259,25 @@ class field
         int total_move_cost() const;
 
     private:
-        // A pointer lookup table of all field effects on the current tile.
-        std::map<field_type_id, field_entry> _field_type_list;
+        // Entries stored in the field itself, tiles rarely have more than fire, smoke and hot air.
+        static constexpr int block_size = 3;
+
+        struct entry_block {
+            std::array<value_type, block_size> entries;
+            // Bit i is set if entries[i] is in use.
+            uint8_t used = 0;
+            std::unique_ptr<entry_block> next;
+        };
+
+        value_type &entry_at( int slot );
+        const value_type &entry_at( int slot ) const;
+        /** Slot of the entry following the one in @p slot in type order, -1 if there is none. */
+        int next_slot( int slot ) const;
+        /** Slot of the entry with the given type, -1 if there is none. */
+        int find_slot( const field_type_id &type ) const;
+
+        // The field effects on the current tile, in no particular order.
+        entry_block _entries;
         //_displayed_field_type currently is equal to the last field added to the square. You can modify this behavior in the class functions if you wish.
         field_type_id _displayed_field_type;
 };
@@ -31,6 +31,7 @@
 #include "artifact.h"
 #include "auto_pickup.h"
 #include "avatar.h"
+#include "background_save.h"
 #include "avatar_action.h"
 #include "bionics.h"
 #include "bodypart.h"
@@ -46,6 +47,7 @@
 #include "creature_tracker.h"
 #include "cursesport.h"
 #include "debug.h"
+#include "debug_menu.h"
 #include "dependency_tree.h"
 #include "editmap.h"
 #include "enums.h"
@@ -83,6 +85,7 @@
 #include "mod_manager.h"
 #include "monattack.h"
 #include "monexamine.h"
+#include "monfaction.h"
 #include "monstergenerator.h"
 #include "morale_types.h"
 #include "mtype.h"
@@ -105,6 +108,7 @@
 #include "scent_map.h"
 #include "scores_ui.h"
 #include "sdltiles.h"
+#include "sight_cache.h"
 #include "sounds.h"
 #include "start_location.h"
 #include "stats_tracker.h"
@@ -134,6 +138,7 @@
 #include "iuse.h"
 #include "player.h"
 #include "player_activity.h"
+#include "profiler.h"
 #include "recipe.h"
 #include "ret_val.h"
 #include "tileray.h"
@@ -1495,6 +1500,9 @@ bool game::do_turn()
         }
     }
 
+    // Only the world update is timed, not the time spent waiting for input.
+    CATA_PROFILE_ZONE( "game::do_turn" );
+
     if( driving_view_offset.x != 0 || driving_view_offset.y != 0 ) {
         // Still have a view offset, but might not be driving anymore,
         // or the option has been deactivated,
@@ -1517,18 +1525,38 @@ bool game::do_turn()
 
     m.process_falling();
     autopilot_vehicles();
-    m.vehmove();
-    m.process_fields();
-    m.process_active_items();
+    // Nothing outside of the map is in use between turns.
+    MAPBUFFER.enforce_memory_budget();
+    // Before moving vehicles, they are what shifts the map the most.
+    prefetch_submaps();
+    {
+        CATA_PROFILE_ZONE( "map::vehmove" );
+        m.vehmove();
+    }
+    {
+        CATA_PROFILE_ZONE( "map::process_fields" );
+        m.process_fields();
+    }
+    {
+        CATA_PROFILE_ZONE( "map::process_active_items" );
+        m.process_active_items();
+    }
     m.creature_in_field( u );
 
-    // Apply sounds from previous turn to monster and NPC AI.
-    sounds::process_sounds();
+    {
+        // Apply sounds from previous turn to monster and NPC AI.
+        CATA_PROFILE_ZONE( "sounds::process_sounds" );
+        sounds::process_sounds();
+    }
     // Update vision caches for monsters. If this turns out to be expensive,
     // consider a stripped down cache just for monsters.
     m.build_map_cache( get_levz(), true );
-    monmove();
+    {
+        CATA_PROFILE_ZONE( "game::monmove" );
+        monmove();
+    }
     if( calendar::once_every( 5_minutes ) ) {
+        CATA_PROFILE_ZONE( "game::overmap_npc_move" );
         overmap_npc_move();
     }
     if( calendar::once_every( 10_seconds ) ) {
@@ -1540,7 +1568,10 @@ bool game::do_turn()
         }
     }
     update_stair_monsters();
-    mon_info_update();
+    {
+        CATA_PROFILE_ZONE( "game::mon_info_update" );
+        mon_info_update();
+    }
     u.process_turn();
     if( u.moves < 0 && get_option<bool>( "FORCE_REDRAW" ) ) {
         draw();
@@ -2663,6 +2694,7 @@ bool game::load( const std::string &world )
 
 void game::load( const save_t &name )
 {
+    background_save::wait();
     popup_status( _( "Please wait…" ), _( "Loading the save…" ) );
 
     using namespace std::placeholders;
@@ -2933,6 +2965,13 @@ spell_events &game::spell_events_subscriber()
 
 bool game::save()
 {
+    // The files of the previous save have to be on disk before they are replaced again.
+    background_save::wait();
+    // Everything is serialized here, the files are written by the background writer thread.
+    background_save::begin();
+    const on_out_of_scope end_collecting( []() {
+        background_save::end();
+    } );
     try {
         if( !save_player_data() ||
             !save_factions_missions_npcs() ||
@@ -3143,6 +3182,7 @@ void game::draw()
     wrefresh( w_terrain );
 
     draw_panels( false );
+    debug_menu::draw_profiler_overlay();
 }
 
 void game::draw_panels( bool force_draw )
@@ -4094,9 +4134,55 @@ void game::cleanup_dead()
     critter_died = false;
 }
 
+void game::prefetch_monster_sight()
+{
+    CATA_PROFILE_ZONE( "game::prefetch_monster_sight" );
+    // The creatures monster::plan rates as targets: those of hostile factions (and NPCs),
+    // and its own faction if it moves with it.
+    static const mfaction_str_id player_faction( "player" );
+    const auto faction_of = []( const monster & critter ) {
+        return critter.friendly == 0 ? critter.faction : player_faction.id();
+    };
+    std::vector<std::pair<tripoint, tripoint>> lines;
+    for( monster &critter : all_monsters() ) {
+        if( critter.has_effect( effect_controlled ) || !critter.can_see() ) {
+            continue;
+        }
+        const bool rates_own_faction = critter.has_flag( MF_SWARMS ) ||
+                                       ( critter.has_flag( MF_GROUP_MORALE ) && critter.morale < critter.type->morale );
+        const mfaction_id own_faction = faction_of( critter );
+        const auto rates = [&]( const mfaction_id & other ) {
+            if( other == own_faction ) {
+                return rates_own_faction;
+            }
+            const mf_attitude att = own_faction.obj().attitude( other );
+            return att != MFA_NEUTRAL && att != MFA_FRIENDLY;
+        };
+        const int range = std::max( critter.type->vision_day, critter.type->vision_night );
+        for( monster *const other : critter_tracker->creatures_in_radius( critter.pos(), range ) ) {
+            if( other != &critter && rates( faction_of( *other ) ) ) {
+                lines.emplace_back( critter.pos(), other->pos() );
+            }
+        }
+        for( const npc &guy : all_npcs() ) {
+            if( rl_dist( critter.pos(), guy.pos() ) <= range && rates( guy.get_monster_faction() ) ) {
+                lines.emplace_back( critter.pos(), guy.pos() );
+            }
+        }
+    }
+    m.prefetch_sight_lines( lines );
+}
+
 void game::monmove()
 {
     cleanup_dead();
+    // Whatever the player did this turn may change who sees whom, and the player acts on
+    // fresh answers again after the monsters and NPCs are done.
+    creature_sight->start();
+    const on_out_of_scope stop_sight_cache( [this]() {
+        creature_sight->stop();
+    } );
+    prefetch_monster_sight();
 
     for( monster &critter : all_monsters() ) {
         // Critters in impassable tiles get pushed away, unless it's not impassable for them
@@ -10010,7 +10096,11 @@ void game::vertical_shift( const int z_after )
     // TODO: Implement dragging stuff up/down
     u.grab( OBJECT_NONE );
 
-    scent.reset();
+    // With z-levels, each level keeps its own scent. Without them, the map of the
+    // old level is unloaded, and its scent goes with it.
+    if( !m.has_zlevels() ) {
+        scent.reset();
+    }
 
     u.setz( z_after );
     const int z_before = get_levz();
@@ -10688,6 +10778,54 @@ void game::quicksave()
     last_save_timestamp = now;
 }
 
+void game::prefetch_submaps()
+{
+    // How many turns ahead the submaps are read.
+    constexpr int prefetch_turns = 3;
+
+    // Where the avatar is going, in map squares per turn.
+    const tripoint abs_pos = m.getabs( u.pos() );
+    point velocity = abs_pos.xy() - last_prefetch_pos.xy();
+    last_prefetch_pos = abs_pos;
+    const optional_vpart_position vp = m.veh_at( u.pos() );
+    if( vp && u.in_vehicle && vp->vehicle().velocity != 0 ) {
+        // The heading of the vehicle already points where it turns to.
+        const vehicle &veh = vp->vehicle();
+        const double angle = veh.face.dir() * M_PI / 180;
+        const double speed = veh.velocity / vehicles::vmiph_per_tile;
+        velocity = point( std::lround( std::cos( angle ) * speed ),
+                          std::lround( std::sin( angle ) * speed ) );
+    }
+    if( std::abs( velocity.x ) >= MAPSIZE_X || std::abs( velocity.y ) >= MAPSIZE_Y ) {
+        // Teleported or moved by something else that will not happen again next turn.
+        velocity = point_zero;
+    }
+
+    std::set<tripoint> quads;
+    if( velocity != point_zero ) {
+        const point map_origin = m.get_abs_sub().xy();
+        const int zmin = m.has_zlevels() ? -OVERMAP_DEPTH : get_levz();
+        const int zmax = m.has_zlevels() ? OVERMAP_HEIGHT : get_levz();
+        for( int turn = 1; turn <= prefetch_turns; turn++ ) {
+            // The map is centered on the submap of the avatar.
+            const point target = ms_to_sm_copy( abs_pos.xy() + velocity * turn ) -
+                                 point( HALF_MAPSIZE, HALF_MAPSIZE );
+            for( int x = target.x; x < target.x + MAPSIZE; x++ ) {
+                for( int y = target.y; y < target.y + MAPSIZE; y++ ) {
+                    if( x >= map_origin.x && x < map_origin.x + MAPSIZE &&
+                        y >= map_origin.y && y < map_origin.y + MAPSIZE ) {
+                        continue;
+                    }
+                    for( int z = zmin; z <= zmax; z++ ) {
+                        quads.insert( sm_to_omt_copy( tripoint( x, y, z ) ) );
+                    }
+                }
+            }
+        }
+    }
+    MAPBUFFER.prefetch( quads );
+}
+
 void game::quickload()
 {
     const WORLDPTR active_world = world_generator->active_world;
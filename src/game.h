@@ -17,6 +17,7 @@
 #include <unordered_set>
 
 #include "action.h"
+#include "benchmark.h"
 #include "calendar.h"
 #include "character_id.h"
 #include "cursesdef.h"
@@ -106,6 +107,7 @@ class player;
 class stats_tracker;
 class vehicle;
 class Creature_tracker;
+class sight_cache;
 class scenario;
 class map_item_stack;
 struct WORLD;
@@ -150,6 +152,7 @@ class game
         friend class advanced_inventory;
         friend class main_menu;
         friend class target_handler;
+        friend bool benchmark::run_turns( int turns, std::ostream &out );
     public:
         game();
         ~game();
@@ -848,6 +851,11 @@ class game
 
         // Routine loop functions, approximately in order of execution
         void monmove();          // Monster movement
+        /**
+         * First part of @ref monmove: works out the lines of sight that @ref monster::plan
+         * will need on worker threads, see @ref map::prefetch_sight_lines.
+         */
+        void prefetch_monster_sight();
         void overmap_npc_move(); // NPC overmap movement
         void process_activity(); // Processes and enacts the player's activity
         void handle_key_blocking_activity(); // Abort reading etc.
@@ -884,6 +892,8 @@ class game
         void items_browser();		// open items browser
     private:
         void quickload();        // Loads the previously saved game if it exists
+        /** Reads the saved submaps the map is going to load soon in the background. */
+        void prefetch_submaps();
 
         // Input related
         // Handles box showing items under mouse
@@ -943,6 +953,8 @@ class game
         spell_events &spell_events_subscriber();
 
         pimpl<Creature_tracker> critter_tracker;
+        /** What the creatures saw during game::monmove, see @ref sight_cache. */
+        pimpl<sight_cache> creature_sight;
         pimpl<faction_manager> faction_manager_ptr;
 
         /** Used in main.cpp to determine what type of quit is being performed. */
@@ -1016,6 +1028,8 @@ class game
         std::set<character_id> follower_ids; // Keep track of follower NPC IDs
         int moves_since_last_save = 0;
         time_t last_save_timestamp;
+        /** Absolute position of the avatar when @ref prefetch_submaps was called the last time. */
+        tripoint last_prefetch_pos;
         mutable std::array<float, OVERMAP_LAYERS> latest_lightlevels;
         // remoteveh() cache
         time_point remoteveh_cache_time;
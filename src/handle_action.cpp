@@ -12,6 +12,7 @@
 #include "auto_note.h"
 #include "avatar.h"
 #include "avatar_action.h"
+#include "background_save.h"
 #include "bionics.h"
 #include "calendar.h"
 #include "clzones.h"
@@ -2261,7 +2262,8 @@ bool game::handle_action()
 
             case ACTION_SAVE:{
                 if( query_yn( _( "Save and quit?" ) ) ) {
-                    if( save() ) {
+                    // Only quit once everything is on disk.
+                    if( save() && background_save::wait() ) {
                         u.moves = 0;
                         uquit = QUIT_SAVED;
                     }
@@ -1,7 +1,10 @@
 #include "init.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
+#include <deque>
 #include <fstream>
 #include <sstream> // for throwing errors
 #include <string>
@@ -20,6 +23,7 @@
 #include "construction.h"
 #include "crafting_gui.h"
 #include "creature.h"
+#include "data_snapshot.h"
 #include "debug.h"
 #include "dialogue.h"
 #include "effect.h"
@@ -71,6 +75,7 @@
 #include "start_location.h"
 #include "string_formatter.h"
 #include "text_snippets.h"
+#include "thread_pool.h"
 #include "trap.h"
 #include "gamemode_tutorial.h"
 #include "veh_type.h"
@@ -85,6 +90,8 @@
 #include "clothing_mod.h"
 #include "ammo_effect.h"
 
+extern bool test_mode;
+
 DynamicDataLoader::DynamicDataLoader()
 {
     initialize();
@@ -117,8 +124,7 @@ void DynamicDataLoader::load_deferred( deferred_json &data )
         auto it = data.begin();
         for( size_t idx = 0; idx != n; ++idx ) {
             try {
-                std::istringstream str( it->first );
-                JsonIn jsin( str );
+                JsonIn jsin( it->first );
                 JsonObject jo = jsin.get_object();
                 load_object( jo, it->second );
             } catch( const std::exception &err ) {
@@ -400,8 +406,65 @@ void DynamicDataLoader::initialize()
 #endif
 }
 
+namespace
+{
+
+// A data file, split into its top level objects on a worker thread.
+struct parsed_json_file {
+    std::unique_ptr<JsonIn> jsin;
+    std::deque<JsonObject> objects;
+    std::exception_ptr error;
+};
+
+// Indexing the members of an object is a full pass over its text, so this is most of the
+// parsing work. The objects still refer to jsin, which must only be used by one thread at a time.
+// They are kept in a deque, destroying a JsonObject (like a vector does when it grows) seeks
+// jsin back to its end.
+std::deque<JsonObject> split_into_objects( JsonIn &jsin )
+{
+    std::deque<JsonObject> objects;
+    if( jsin.test_object() ) {
+        // a single object
+        objects.emplace_back( jsin );
+        // if there's anything else in the file, it's an error.
+        jsin.eat_whitespace();
+        if( jsin.good() ) {
+            jsin.error( string_format( "expected single-object file but found '%c'", jsin.peek() ) );
+        }
+    } else if( jsin.test_array() ) {
+        jsin.start_array();
+        int previous_start = -1;
+        while( !jsin.end_array() ) {
+            // Each object of the file has to be loaded exactly once.
+            const int start = jsin.tell();
+            if( start <= previous_start ) {
+                jsin.error( "object was read twice" );
+            }
+            objects.emplace_back( jsin );
+            previous_start = start;
+        }
+    } else {
+        // not an object or an array?
+        jsin.error( "expected object or array" );
+    }
+    return objects;
+}
+
+// @p content has to outlive the result.
+void parse_json_file( const std::string &content, parsed_json_file &result )
+{
+    try {
+        result.jsin = std::make_unique<JsonIn>( content );
+        result.objects = split_into_objects( *result.jsin );
+    } catch( ... ) {
+        result.error = std::current_exception();
+    }
+}
+
+} // namespace
+
 void DynamicDataLoader::load_data_from_path( const std::string &path, const std::string &src,
-        loading_ui &ui )
+        loading_ui & )
 {
     assert( !finalized && "Can't load additional data after finalization.  Must be unloaded first." );
     // We assume that each folder is consistent in itself,
@@ -420,58 +483,53 @@ void DynamicDataLoader::load_data_from_path( const std::string &path, const std:
             files.push_back( path );
         }
     }
-    // iterate over each file
-    for( auto &files_i : files ) {
-        const std::string &file = files_i;
-        // open the file as a stream
-        std::ifstream infile( file.c_str(), std::ifstream::in | std::ifstream::binary );
-        // and stuff it into ram
-        std::istringstream iss(
-            std::string(
-                ( std::istreambuf_iterator<char>( infile ) ),
-                std::istreambuf_iterator<char>()
-            )
-        );
-        try {
-            // parse it
-            JsonIn jsin( iss );
-            load_all_from_json( jsin, src, ui, path, file );
-        } catch( const JsonError &err ) {
-            throw std::runtime_error( file + ": " + err.what() );
+    // The files are read and parsed in parallel, a batch at a time to limit the memory that
+    // is used. The objects are then loaded on this thread in the same order as before,
+    // because later objects may depend on earlier ones.
+    std::vector<uint64_t> content_hashes( files.size() );
+    const size_t batch_size = 64;
+    for( size_t batch_start = 0; batch_start < files.size(); batch_start += batch_size ) {
+        const size_t batch_end = std::min( files.size(), batch_start + batch_size );
+        // The objects refer to the contents, so they are destroyed first.
+        std::vector<std::string> contents( batch_end - batch_start );
+        std::vector<parsed_json_file> parsed( batch_end - batch_start );
+        shared_thread_pool().parallel_for( 0, static_cast<int>( parsed.size() ), [&]( const int i ) {
+            contents[i] = data_snapshot::read_file( files[batch_start + i] );
+            content_hashes[batch_start + i] = data_snapshot::content_hash( contents[i] );
+            parse_json_file( contents[i], parsed[i] );
+        } );
+        for( size_t i = 0; i < parsed.size(); i++ ) {
+            const std::string &file = files[batch_start + i];
+            try {
+                if( parsed[i].error ) {
+                    std::rethrow_exception( parsed[i].error );
+                }
+                for( JsonObject &jo : parsed[i].objects ) {
+                    load_object( jo, src, path, file );
+                    jo.finish();
+                }
+            } catch( const JsonError &err ) {
+                throw std::runtime_error( file + ": " + err.what() );
+            }
         }
     }
+    content_keys.push_back( src + ' ' + path + ' ' +
+                            data_snapshot::content_key( files, content_hashes ) );
 }
 
 void DynamicDataLoader::load_all_from_json( JsonIn &jsin, const std::string &src, loading_ui &,
         const std::string &base_path, const std::string &full_path )
 {
-    if( jsin.test_object() ) {
-        // find type and dispatch single object
-        JsonObject jo = jsin.get_object();
+    for( JsonObject &jo : split_into_objects( jsin ) ) {
         load_object( jo, src, base_path, full_path );
         jo.finish();
-        // if there's anything else in the file, it's an error.
-        jsin.eat_whitespace();
-        if( jsin.good() ) {
-            jsin.error( string_format( "expected single-object file but found '%c'", jsin.peek() ) );
-        }
-    } else if( jsin.test_array() ) {
-        jsin.start_array();
-        // find type and dispatch each object until array close
-        while( !jsin.end_array() ) {
-            JsonObject jo = jsin.get_object();
-            load_object( jo, src, base_path, full_path );
-            jo.finish();
-        }
-    } else {
-        // not an object or an array?
-        jsin.error( "expected object or array" );
     }
 }
 
 void DynamicDataLoader::unload_data()
 {
     finalized = false;
+    content_keys.clear();
 
     harvest_list::reset();
     json_flag::reset();
@@ -631,6 +689,13 @@ void DynamicDataLoader::finalize_loaded_data( loading_ui &ui )
 
 void DynamicDataLoader::check_consistency( loading_ui &ui )
 {
+    // The checks only depend on the data and the game, they passed before if both are unchanged.
+    const std::string validation_key = data_snapshot::validation_key( content_keys );
+    if( !test_mode && data_snapshot::was_validated( validation_key ) ) {
+        return;
+    }
+    const bool had_errors = debug_has_error_been_observed();
+
     ui.new_context( _( "Verifying" ) );
 
     using named_entry = std::pair<std::string, std::function<void()>>;
@@ -712,6 +777,9 @@ void DynamicDataLoader::check_consistency( loading_ui &ui )
         e.second();
         ui.proceed();
     }
+    if( !had_errors && !debug_has_error_been_observed() ) {
+        data_snapshot::mark_validated( validation_key );
+    }
     catacurses::erase();
     catacurses::refresh();
 }
@@ -65,6 +65,8 @@ class DynamicDataLoader
 
     private:
         bool finalized = false;
+        /** Identifies the data loaded since @ref unload_data, see @ref data_snapshot::content_key. */
+        std::vector<std::string> content_keys;
 
     protected:
         /**
@@ -107,6 +109,8 @@ class DynamicDataLoader
         void initialize();
         /**
          * Check the consistency of all the loaded data.
+         * Skipped if the same data already passed the checks in this version of the game,
+         * except in test mode (e.g. `--check-mods`).
          * May print a debugmsg if something seems wrong.
          * @param ui Finalization status display.
          */
@@ -123,6 +127,8 @@ class DynamicDataLoader
          * @param path Either a folder (recursively load all
          * files with the extension .json), or a file (load only
          * that file, don't check extension).
+         * The files are parsed on the shared thread pool, the objects
+         * are loaded on the calling thread in file order.
          * @param src String identifier for mod this data comes from
          * @param ui Finalization status display.
          * @throws std::exception on all kind of errors.
@@ -7464,7 +7464,7 @@ static bool item_read_extended_photos( item &it, std::vector<extended_photo_def>
                                        const std::string &var_name, bool insert_at_begin )
 {
     bool result = false;
-    std::istringstream extended_photos_data( it.get_var( var_name ) );
+    const std::string extended_photos_data = it.get_var( var_name );
     JsonIn json( extended_photos_data );
     if( insert_at_begin ) {
         std::vector<extended_photo_def> temp_vec;
@@ -1,5 +1,6 @@
 #include "json.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cmath> // pow
@@ -30,6 +31,41 @@ static bool is_whitespace( char ch )
     return ( ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' );
 }
 
+static constexpr uint64_t repeat_byte( const unsigned char byte )
+{
+    return 0x0101010101010101ULL * byte;
+}
+
+// Whether any byte of the word is a '"', a '\\' or a control character. Each test sets the
+// high bit of a byte that matches, bytes above 0x7f (UTF-8) never match.
+static bool has_special_string_char( const uint64_t word )
+{
+    const uint64_t quote = word ^ repeat_byte( '"' );
+    const uint64_t backslash = word ^ repeat_byte( '\\' );
+    const uint64_t matches = ( ( quote - repeat_byte( 0x01 ) ) & ~quote ) |
+                             ( ( backslash - repeat_byte( 0x01 ) ) & ~backslash ) |
+                             ( ( word - repeat_byte( 0x20 ) ) & ~word );
+    return ( matches & repeat_byte( 0x80 ) ) != 0;
+}
+
+// Returns the first character in [p, end) that needs special handling inside a string.
+// Most strings contain none of them, so they are skipped eight characters at a time.
+static const char *skip_plain_string_chars( const char *p, const char *const end )
+{
+    uint64_t word;
+    while( end - p >= static_cast<std::ptrdiff_t>( sizeof( word ) ) ) {
+        memcpy( &word, p, sizeof( word ) );
+        if( has_special_string_char( word ) ) {
+            break;
+        }
+        p += sizeof( word );
+    }
+    while( p < end && *p != '"' && *p != '\\' && static_cast<unsigned char>( *p ) >= 0x20 ) {
+        ++p;
+    }
+    return p;
+}
+
 // for parsing \uxxxx escapes
 static std::string utf16_to_utf8( uint32_t ch )
 {
@@ -708,43 +744,112 @@ void add_array_to_set( std::set<std::string> &s, const JsonObject &json, const s
     }
 }
 
+// Moves @p line and @p column past the text from @p begin to @p end.
+static void count_position( const char *begin, const char *end, int &line, int &column )
+{
+    for( const char *p = begin; p < end; ++p ) {
+        if( *p == '\r' ) {
+            column = 1;
+            ++line;
+            if( p + 1 < end && *( p + 1 ) == '\n' ) {
+                ++p;
+            }
+        } else if( *p == '\n' ) {
+            column = 1;
+            ++line;
+        } else {
+            ++column;
+        }
+    }
+}
+
+JsonIn::JsonIn( std::istream &s )
+{
+    // Everything is read up front, parsing only has to move a pointer through memory.
+    const std::streampos start = s.tellg();
+    if( start != std::streampos( -1 ) && s.seekg( 0, std::istream::end ) ) {
+        const std::streamoff size = s.tellg() - start;
+        s.seekg( start );
+        owned_data.resize( static_cast<size_t>( size ) );
+        s.read( &owned_data[0], size );
+        // Text mode streams may deliver fewer characters than the file size.
+        owned_data.resize( static_cast<size_t>( s.gcount() ) );
+        data_offset = static_cast<int>( start );
+        if( data_offset > 0 ) {
+            // Error messages count the lines from the start of the stream, like the offsets.
+            std::string skipped( static_cast<size_t>( data_offset ), '\0' );
+            s.clear();
+            s.seekg( 0 );
+            s.read( &skipped[0], data_offset );
+            count_position( skipped.data(), skipped.data() + s.gcount(), data_line, data_column );
+            s.clear();
+            s.seekg( 0, std::istream::end );
+        }
+    } else {
+        s.clear();
+        owned_data.assign( std::istreambuf_iterator<char>( s ), std::istreambuf_iterator<char>() );
+    }
+    data_begin = owned_data.data();
+    data_end = data_begin + owned_data.size();
+    cur = data_begin;
+}
+
+JsonIn::JsonIn( const std::string &data ) :
+    data_begin( data.data() ), data_end( data.data() + data.size() ), cur( data.data() )
+{
+}
+
 int JsonIn::tell()
 {
-    return stream->tellg();
+    return data_offset + ( cur - data_begin );
 }
 char JsonIn::peek()
 {
-    return static_cast<char>( stream->peek() );
+    return cur < data_end ? *cur : static_cast<char>( EOF );
 }
 bool JsonIn::good()
 {
-    return stream->good();
+    return cur < data_end;
 }
 
 void JsonIn::seek( int pos )
 {
-    stream->clear();
-    stream->seekg( pos );
+    cur = data_begin + std::max( 0, std::min<int>( pos - data_offset, data_end - data_begin ) );
     ate_separator = false;
 }
 
 void JsonIn::eat_whitespace()
 {
-    while( is_whitespace( peek() ) ) {
-        stream->get();
+    while( cur < data_end && is_whitespace( *cur ) ) {
+        ++cur;
     }
 }
 
 void JsonIn::uneat_whitespace()
 {
-    while( tell() > 0 ) {
-        stream->seekg( -1, std::istream::cur );
-        if( !is_whitespace( peek() ) ) {
+    while( cur > data_begin ) {
+        --cur;
+        if( !is_whitespace( *cur ) ) {
             break;
         }
     }
 }
 
+bool JsonIn::skip_literal( const char *text )
+{
+    const size_t length = strlen( text );
+    if( static_cast<size_t>( data_end - cur ) < length || memcmp( cur, text, length ) != 0 ) {
+        return false;
+    }
+    cur += length;
+    return true;
+}
+
+std::string JsonIn::peek_text( const size_t length ) const
+{
+    return std::string( cur, std::min<size_t>( length, data_end - cur ) );
+}
+
 void JsonIn::end_value()
 {
     ate_separator = false;
@@ -766,7 +871,7 @@ void JsonIn::skip_separator()
         if( ate_separator ) {
             error( "duplicate separator" );
         }
-        stream->get();
+        ++cur;
         ate_separator = true;
     } else if( ch == ']' || ch == '}' || ch == ':' ) {
         // okay
@@ -793,34 +898,37 @@ void JsonIn::skip_separator()
 
 void JsonIn::skip_pair_separator()
 {
-    char ch;
     eat_whitespace();
-    stream->get( ch );
+    const char ch = peek();
     if( ch != ':' ) {
         std::stringstream err;
         err << "expected pair separator ':', not '" << ch << "'";
-        error( err.str(), -1 );
+        error( err.str() );
     } else if( ate_separator ) {
-        error( "duplicate separator not strictly allowed", -1 );
+        error( "duplicate separator not strictly allowed" );
     }
+    ++cur;
     ate_separator = true;
 }
 
 void JsonIn::skip_string()
 {
-    char ch;
     eat_whitespace();
-    stream->get( ch );
-    if( ch != '"' ) {
+    const char first = peek();
+    if( first != '"' ) {
         std::stringstream err;
-        err << "expecting string but found '" << ch << "'";
-        error( err.str(), -1 );
+        err << "expecting string but found '" << first << "'";
+        error( err.str() );
     }
-    while( stream->good() ) {
-        stream->get( ch );
+    ++cur;
+    while( cur < data_end ) {
+        cur = skip_plain_string_chars( cur, data_end );
+        if( cur == data_end ) {
+            break;
+        }
+        const char ch = *cur++;
         if( ch == '\\' ) {
-            stream->get( ch );
-            continue;
+            advance();
         } else if( ch == '"' ) {
             break;
         } else if( ch == '\r' || ch == '\n' ) {
@@ -882,55 +990,48 @@ void JsonIn::skip_array()
 
 void JsonIn::skip_true()
 {
-    char text[5];
     eat_whitespace();
-    stream->get( text, 5 );
-    if( strcmp( text, "true" ) != 0 ) {
+    if( !skip_literal( "true" ) ) {
         std::stringstream err;
-        err << R"(expected "true", but found ")" << text << "\"";
-        error( err.str(), -4 );
+        err << R"(expected "true", but found ")" << peek_text( 4 ) << "\"";
+        error( err.str() );
     }
     end_value();
 }
 
 void JsonIn::skip_false()
 {
-    char text[6];
     eat_whitespace();
-    stream->get( text, 6 );
-    if( strcmp( text, "false" ) != 0 ) {
+    if( !skip_literal( "false" ) ) {
         std::stringstream err;
-        err << R"(expected "false", but found ")" << text << "\"";
-        error( err.str(), -5 );
+        err << R"(expected "false", but found ")" << peek_text( 5 ) << "\"";
+        error( err.str() );
     }
     end_value();
 }
 
 void JsonIn::skip_null()
 {
-    char text[5];
     eat_whitespace();
-    stream->get( text, 5 );
-    if( strcmp( text, "null" ) != 0 ) {
+    if( !skip_literal( "null" ) ) {
         std::stringstream err;
-        err << R"(expected "null", but found ")" << text << "\"";
-        error( err.str(), -4 );
+        err << R"(expected "null", but found ")" << peek_text( 4 ) << "\"";
+        error( err.str() );
     }
     end_value();
 }
 
 void JsonIn::skip_number()
 {
-    char ch;
     eat_whitespace();
     // skip all of (+-0123456789.eE)
-    while( stream->good() ) {
-        stream->get( ch );
+    while( cur < data_end ) {
+        const char ch = *cur;
         if( ch != '+' && ch != '-' && ( ch < '0' || ch > '9' ) &&
             ch != 'e' && ch != 'E' && ch != '.' ) {
-            stream->unget();
             break;
         }
+        ++cur;
     }
     end_value();
 }
@@ -944,84 +1045,70 @@ std::string JsonIn::get_member_name()
 
 std::string JsonIn::get_string()
 {
-    std::string s;
-    char ch;
-    bool backslash = false;
-    char unihex[5] = "0000";
     eat_whitespace();
-    int startpos = tell();
+    const int startpos = tell();
     // the first character had better be a '"'
-    stream->get( ch );
-    if( ch != '"' ) {
+    const char first = peek();
+    if( first != '"' ) {
         std::stringstream err;
-        err << "expecting string but got '" << ch << "'";
-        error( err.str(), -1 );
+        err << "expecting string but got '" << first << "'";
+        error( err.str() );
     }
-    // add chars to the string, one at a time, converting:
+    ++cur;
+    std::string s;
+    // add the plain characters in chunks, converting:
     // \", \\, \/, \b, \f, \n, \r, \t and \uxxxx according to JSON spec.
-    while( stream->good() ) {
-        stream->get( ch );
-        if( ch == '\\' ) {
-            if( backslash ) {
-                s += '\\';
-                backslash = false;
-            } else {
-                backslash = true;
-                continue;
-            }
-        } else if( backslash ) {
-            backslash = false;
-            if( ch == '"' ) {
-                s += '"';
-            } else if( ch == '/' ) {
-                s += '/';
-            } else if( ch == 'b' ) {
-                s += '\b';
-            } else if( ch == 'f' ) {
-                s += '\f';
-            } else if( ch == 'n' ) {
-                s += '\n';
-            } else if( ch == 'r' ) {
-                s += '\r';
-            } else if( ch == 't' ) {
-                s += '\t';
-            } else if( ch == 'u' ) {
-                // get the next four characters as hexadecimal
-                stream->get( unihex, 5 );
-                // insert the appropriate unicode character in utf8
-                // TODO: verify that unihex is in fact 4 hex digits.
-                char **endptr = nullptr;
-                uint32_t u = static_cast<uint32_t>( strtoul( unihex, endptr, 16 ) );
-                try {
-                    s += utf16_to_utf8( u );
-                } catch( const std::exception &err ) {
-                    error( err.what() );
-                }
-            } else {
-                // for anything else, just add the character, i suppose
-                s += ch;
-            }
-        } else if( ch == '"' ) {
+    while( cur < data_end ) {
+        const char *const plain_end = skip_plain_string_chars( cur, data_end );
+        s.append( cur, plain_end );
+        cur = plain_end;
+        if( cur == data_end ) {
+            break;
+        }
+        const char ch = *cur++;
+        if( ch == '"' ) {
             // end of the string
             end_value();
             return s;
         } else if( ch == '\r' || ch == '\n' ) {
             error( "reached end of line without closing string", -1 );
-        } else if( static_cast<unsigned char>( ch ) < 0x20 ) {
+        } else if( ch != '\\' ) {
             error( "invalid character inside string", -1 );
+        }
+        if( cur == data_end ) {
+            break;
+        }
+        const char escaped = *cur++;
+        if( escaped == 'b' ) {
+            s += '\b';
+        } else if( escaped == 'f' ) {
+            s += '\f';
+        } else if( escaped == 'n' ) {
+            s += '\n';
+        } else if( escaped == 'r' ) {
+            s += '\r';
+        } else if( escaped == 't' ) {
+            s += '\t';
+        } else if( escaped == 'u' ) {
+            // get the next four characters as hexadecimal
+            const std::string unihex = peek_text( 4 );
+            cur += unihex.size();
+            // insert the appropriate unicode character in utf8
+            // TODO: verify that unihex is in fact 4 hex digits.
+            uint32_t u = static_cast<uint32_t>( strtoul( unihex.c_str(), nullptr, 16 ) );
+            try {
+                s += utf16_to_utf8( u );
+            } catch( const std::exception &err ) {
+                error( err.what() );
+            }
         } else {
-            s += ch;
+            // '"', '\\', '/' and anything else is added as it is
+            s += escaped;
         }
     }
-    // if we get to here, probably hit a premature EOF?
-    if( stream->eof() ) {
-        stream->clear();
-        seek( startpos );
-        error( "couldn't find end of string, reached EOF." );
-    } else if( stream->fail() ) {
-        throw JsonError( "stream failure while reading string." );
-    }
-    throw JsonError( "something went wrong D:" );
+    // if we get to here, we hit a premature EOF
+    seek( startpos );
+    error( "couldn't find end of string, reached EOF." );
 }
 
 // These functions get -INT_MIN and -INT64_MIN while very carefully avoiding any overflow.
@@ -1153,59 +1240,61 @@ double JsonIn::get_float()
 number_sci_notation JsonIn::get_any_number()
 {
     // this could maybe be prettier?
-    char ch;
     number_sci_notation ret;
     int mod_e = 0;
     eat_whitespace();
-    stream->get( ch );
+    // ch is always the next unread character
+    char ch = peek();
+    const auto next = [this]() {
+        advance();
+        return peek();
+    };
     if( ( ret.negative = ch == '-' ) ) {
-        stream->get( ch );
+        ch = next();
     } else if( ch != '.' && ( ch < '0' || ch > '9' ) ) {
         // not a valid float
         std::stringstream err;
         err << "expecting number but found '" << ch << "'";
-        error( err.str(), -1 );
+        error( err.str() );
     }
     if( ch == '0' ) {
         // allow a single leading zero in front of a '.' or 'e'/'E'
-        stream->get( ch );
+        ch = next();
         if( ch >= '0' && ch <= '9' ) {
-            error( "leading zeros not strictly allowed", -1 );
+            error( "leading zeros not strictly allowed" );
         }
     }
     while( ch >= '0' && ch <= '9' ) {
         ret.number *= 10;
         ret.number += ( ch - '0' );
-        stream->get( ch );
+        ch = next();
     }
     if( ch == '.' ) {
-        stream->get( ch );
+        ch = next();
         while( ch >= '0' && ch <= '9' ) {
             ret.number *= 10;
             ret.number += ( ch - '0' );
             mod_e -= 1;
-            stream->get( ch );
+            ch = next();
         }
     }
     if( ch == 'e' || ch == 'E' ) {
-        stream->get( ch );
+        ch = next();
         bool neg;
         if( ( neg = ch == '-' ) ) {
-            stream->get( ch );
+            ch = next();
         } else if( ch == '+' ) {
-            stream->get( ch );
+            ch = next();
         }
         while( ch >= '0' && ch <= '9' ) {
             ret.exp *= 10;
             ret.exp += ( ch - '0' );
-            stream->get( ch );
+            ch = next();
         }
         if( neg ) {
             ret.exp *= -1;
         }
     }
-    // unget the final non-number character (probably a separator)
-    stream->unget();
     end_value();
     ret.exp += mod_e;
     return ret;
@@ -1213,35 +1302,30 @@ number_sci_notation JsonIn::get_any_number()
 
 bool JsonIn::get_bool()
 {
-    char ch;
-    char text[5];
     std::stringstream err;
     eat_whitespace();
-    stream->get( ch );
+    const char ch = peek();
     if( ch == 't' ) {
-        stream->get( text, 4 );
-        if( strcmp( text, "rue" ) == 0 ) {
+        if( skip_literal( "true" ) ) {
             end_value();
             return true;
         } else {
             err << R"(not a boolean.  expected "true", but got ")";
-            err << ch << text << "\"";
-            error( err.str(), -4 );
+            err << peek_text( 4 ) << "\"";
+            error( err.str() );
         }
     } else if( ch == 'f' ) {
-        stream->get( text, 5 );
-        if( strcmp( text, "alse" ) == 0 ) {
+        if( skip_literal( "false" ) ) {
             end_value();
             return false;
         } else {
             err << R"(not a boolean.  expected "false", but got ")";
-            err << ch << text << "\"";
-            error( err.str(), -5 );
+            err << peek_text( 5 ) << "\"";
+            error( err.str() );
         }
     }
     err << "not a boolean value!  expected 't' or 'f' but got '" << ch << "'";
-    error( err.str(), -1 );
-    throw JsonError( "warnings are silly" );
+    error( err.str() );
 }
 
 JsonObject JsonIn::get_object()
@@ -1257,7 +1341,7 @@ void JsonIn::start_array()
 {
     eat_whitespace();
     if( peek() == '[' ) {
-        stream->get();
+        ++cur;
         ate_separator = false;
         return;
     } else {
@@ -1277,7 +1361,7 @@ bool JsonIn::end_array()
             uneat_whitespace();
             error( "separator not strictly allowed at end of array" );
         }
-        stream->get();
+        ++cur;
         end_value();
         return true;
     } else {
@@ -1290,7 +1374,7 @@ void JsonIn::start_object()
 {
     eat_whitespace();
     if( peek() == '{' ) {
-        stream->get();
+        ++cur;
         ate_separator = false; // not that we want to
         return;
     } else {
@@ -1310,7 +1394,7 @@ bool JsonIn::end_object()
             uneat_whitespace();
             error( "separator not strictly allowed at end of object" );
         }
-        stream->get();
+        ++cur;
         end_value();
         return true;
     } else {
@@ -1522,33 +1606,12 @@ bool JsonIn::read( JsonDeserializer &j, bool throw_on_error )
 // WARNING: for occasional use only.
 std::string JsonIn::line_number( int offset_modifier )
 {
-    if( !stream || stream->fail() ) {
-        return "???";
-    }
-    if( stream->eof() ) {
+    if( cur >= data_end ) {
         return "EOF";
-    } // else stream is fine
-    int pos = tell();
-    int line = 1;
-    int offset = 1;
-    char ch;
-    seek( 0 );
-    for( int i = 0; i < pos; ++i ) {
-        stream->get( ch );
-        if( ch == '\r' ) {
-            offset = 1;
-            ++line;
-            if( peek() == '\n' ) {
-                stream->get();
-                ++i;
-            }
-        } else if( ch == '\n' ) {
-            offset = 1;
-            ++line;
-        } else {
-            ++offset;
-        }
     }
+    int line = data_line;
+    int offset = data_column;
+    count_position( data_begin, cur, line, offset );
     std::stringstream ret;
     ret << "line " << line << ":" << ( offset + offset_modifier );
     return ret.str();
@@ -1558,18 +1621,19 @@ void JsonIn::error( const std::string &message, int offset )
 {
     std::ostringstream err;
     err << line_number( offset ) << ": " << message;
-    // if we can't get more info from the stream don't try
-    if( !stream->good() ) {
+    // if we can't get more info from the data don't try
+    if( !good() ) {
         throw JsonError( err.str() );
     }
     // also print surrounding few lines of context, if not too large
     err << "\n\n";
-    stream->seekg( offset, std::istream::cur );
+    seek( tell() + offset );
     size_t pos = tell();
     rewind( 3, 240 );
     size_t startpos = tell();
-    std::string buffer( pos - startpos, '\0' );
-    stream->read( &buffer[0], pos - startpos );
+    const std::string buffer( data_begin + ( startpos - data_offset ),
+                              data_begin + ( pos - data_offset ) );
+    cur = data_begin + ( pos - data_offset );
     auto it = buffer.begin();
     for( ; it < buffer.end() && ( *it == '\r' || *it == '\n' ); ++it ) {
         // skip starting newlines
@@ -1597,10 +1661,11 @@ void JsonIn::error( const std::string &message, int offset )
     err << "^\n";
     seek( pos );
     // if that wasn't the end of the line, continue underneath pointer
-    char ch = stream->get();
+    char ch = peek();
+    advance();
     if( ch == '\r' ) {
         if( peek() == '\n' ) {
-            stream->get();
+            advance();
         }
     } else if( ch == '\n' ) {
         // pass
@@ -1611,16 +1676,13 @@ void JsonIn::error( const std::string &message, int offset )
     }
     // print the next couple lines as well
     int line_count = 0;
-    for( int i = 0; line_count < 3 && stream->good() && i < 240; ++i ) {
-        stream->get( ch );
-        if( !stream->good() ) {
-            break;
-        }
+    for( int i = 0; line_count < 3 && cur < data_end && i < 240; ++i ) {
+        ch = *cur++;
         if( ch == '\r' ) {
             ch = '\n';
             ++line_count;
-            if( stream->peek() == '\n' ) {
-                stream->get( ch );
+            if( peek() == '\n' ) {
+                advance();
             }
         } else if( ch == '\n' ) {
             ++line_count;
@@ -1646,20 +1708,20 @@ void JsonIn::rewind( int max_lines, int max_chars )
 {
     if( max_lines < 0 && max_chars < 0 ) {
         // just rewind to the beginning i guess
-        seek( 0 );
+        seek( data_offset );
         return;
     }
-    if( tell() == 0 ) {
+    if( cur == data_begin ) {
         return;
     }
     int lines_found = 0;
-    stream->seekg( -1, std::istream::cur );
+    --cur;
     for( int i = 0; i < max_chars; ++i ) {
-        size_t tellpos = tell();
+        size_t tellpos = cur - data_begin;
         if( peek() == '\n' ) {
             ++lines_found;
             if( tellpos > 0 ) {
-                stream->seekg( -1, std::istream::cur );
+                --cur;
                 // note: does not update tellpos or count a character
                 if( peek() != '\r' ) {
                     continue;
@@ -1672,25 +1734,20 @@ void JsonIn::rewind( int max_lines, int max_chars )
             break;
         } else if( lines_found == max_lines ) {
             // don't include the last \n or \r
-            stream->seekg( 1, std::istream::cur );
+            ++cur;
             break;
         }
-        stream->seekg( -1, std::istream::cur );
+        --cur;
     }
 }
 
 std::string JsonIn::substr( size_t pos, size_t len )
 {
-    std::string ret;
-    if( len == std::string::npos ) {
-        stream->seekg( 0, std::istream::end );
-        size_t end = tell();
-        len = end - pos;
-    }
-    ret.resize( len );
-    stream->seekg( pos );
-    stream->read( &ret[0], len );
-    return ret;
+    const size_t size = data_end - data_begin;
+    pos = std::min( pos - std::min<size_t>( pos, data_offset ), size );
+    len = std::min( len, size - pos );
+    cur = data_begin + pos + len;
+    return std::string( data_begin + pos, len );
 }
 
 JsonOut::JsonOut( std::ostream &s, bool pretty, int depth ) :
@@ -92,6 +92,10 @@ struct number_sci_notation {
  * The JsonIn class provides a wrapper around a std::istream,
  * with methods for reading JSON data directly from the stream.
  *
+ * The data is parsed from one contiguous block of memory: the istream constructor
+ * reads everything that is left in the stream up front, the string constructor
+ * parses data that is already in memory without copying it.
+ *
  * JsonObject and JsonArray provide higher-level wrappers,
  * and are a little easier to use in most cases,
  * but have the small overhead of indexing the members or elements before use.
@@ -169,15 +173,37 @@ struct number_sci_notation {
 class JsonIn
 {
     private:
-        std::istream *stream;
+        /** Holds the data if it was read from a stream. */
+        std::string owned_data;
+        const char *data_begin;
+        const char *data_end;
+        const char *cur;
+        /** Stream position of @ref data_begin, @ref tell and @ref seek use stream positions. */
+        int data_offset = 0;
+        /** Line and column of @ref data_begin in the stream, for @ref line_number. */
+        int data_line = 1;
+        int data_column = 1;
         bool ate_separator = false;
 
         void skip_separator();
         void skip_pair_separator();
         void end_value();
+        /** Skips the current character, if there is one. */
+        void advance() {
+            if( cur < data_end ) {
+                ++cur;
+            }
+        }
+        /** Skips the literal @p text (e.g. "true") if it comes next, returns whether it did. */
+        bool skip_literal( const char *text );
+        /** Returns up to @p length of the next characters, for error messages. */
+        std::string peek_text( size_t length ) const;
 
     public:
-        JsonIn( std::istream &s ) : stream( &s ) {}
+        JsonIn( std::istream &s );
+        /** Parses @p data in place, it has to outlive this object. */
+        JsonIn( const std::string &data );
+        JsonIn( std::string && ) = delete;
         JsonIn( const JsonIn & ) = delete;
         JsonIn &operator=( const JsonIn & ) = delete;
 
@@ -1,6 +1,8 @@
 #include "lightmap.h" // IWYU pragma: associated
 #include "shadowcasting.h" // IWYU pragma: associated
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstdlib>
 #include <cmath>
@@ -31,7 +33,9 @@
 #include "line.h"
 #include "optional.h"
 #include "player.h"
+#include "profiler.h"
 #include "string_formatter.h"
+#include "thread_pool.h"
 #include "tileray.h"
 #include "type_id.h"
 #include "colony.h"
@@ -87,48 +91,69 @@ bool map::build_transparency_cache( const int zlev )
         return false;
     }
 
-    // Default to just barely not transparent.
-    std::uninitialized_fill_n(
-        &transparency_cache[0][0], MAPSIZE_X * MAPSIZE_Y,
-        static_cast<float>( LIGHT_TRANSPARENCY_OPEN_AIR ) );
+    // The cache is built in three passes so the middle one is a plain loop over the whole
+    // contiguous grid, which the compiler turns into vector code. The order of the
+    // multiplications is the same as when a tile is handled in one go.
 
-    const float sight_penalty = weather::sight_penalty( g->weather.weather );
+    constexpr float open_air = LIGHT_TRANSPARENCY_OPEN_AIR;
+    constexpr float solid = LIGHT_TRANSPARENCY_SOLID;
 
-    // Traverse the submaps in order
+    if( my_MAPSIZE < MAPSIZE ) {
+        // The loops below only cover the submaps of this map.
+        std::uninitialized_fill_n( &transparency_cache[0][0], MAPSIZE_X * MAPSIZE_Y, open_air );
+    }
+
+    // Pass 1: opaque terrain and furniture, everything else defaults to open air.
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
             const auto cur_submap = get_submap_at_grid( {smx, smy, zlev} );
 
-            float zero_value = LIGHT_TRANSPARENCY_OPEN_AIR;
+            if( cur_submap->is_uniform ) {
+                const bool transparent = cur_submap->get_ter( point_zero ).obj().transparent &&
+                                         cur_submap->get_furn( point_zero ).obj().transparent;
+                const float value = transparent ? open_air : solid;
+                for( int sx = 0; sx < SEEX; ++sx ) {
+                    std::fill_n( &transparency_cache[sx + smx * SEEX][smy * SEEY], SEEY, value );
+                }
+                continue;
+            }
+
             for( int sx = 0; sx < SEEX; ++sx ) {
+                float *const column = &transparency_cache[sx + smx * SEEX][smy * SEEY];
                 for( int sy = 0; sy < SEEY; ++sy ) {
-                    const int x = sx + smx * SEEX;
-                    const int y = sy + smy * SEEY;
-
-                    float &value = transparency_cache[x][y];
-                    if( cur_submap->is_uniform && sx + sy > 0 ) {
-                        value = zero_value;
-                        continue;
-                    }
+                    const bool transparent = cur_submap->get_ter( { sx, sy } ).obj().transparent &&
+                                             cur_submap->get_furn( { sx, sy } ).obj().transparent;
+                    column[sy] = transparent ? open_air : solid;
+                }
+            }
+        }
+    }
 
-                    if( !( cur_submap->get_ter( { sx, sy } ).obj().transparent &&
-                           cur_submap->get_furn( {sx, sy } ).obj().transparent ) ) {
-                        value = LIGHT_TRANSPARENCY_SOLID;
-                        zero_value = LIGHT_TRANSPARENCY_SOLID;
-                        continue;
-                    }
+    // Pass 2: weather penalty for transparent tiles that are outside.
+    // FIXME: Places inside vehicles haven't been marked as
+    // inside yet so this is incorrectly penalising for
+    // weather in vehicles.
+    const float sight_penalty = weather::sight_penalty( g->weather.weather );
+    if( sight_penalty != 1.0f ) {
+        float *const values = &transparency_cache[0][0];
+        const bool *const outside = &outside_cache[0][0];
+        for( int i = 0; i < MAPSIZE_X * MAPSIZE_Y; ++i ) {
+            const bool penalized = outside[i] && values[i] != solid;
+            values[i] *= penalized ? sight_penalty : 1.0f;
+        }
+    }
 
-                    if( outside_cache[x][y] ) {
-                        // FIXME: Places inside vehicles haven't been marked as
-                        // inside yet so this is incorrectly penalising for
-                        // weather in vehicles.
-                        value *= sight_penalty;
-                    }
-                    if( cur_submap->is_uniform ) {
-                        if( value == LIGHT_TRANSPARENCY_OPEN_AIR ) {
-                            break;
-                        }
-                        zero_value = value;
+    // Pass 3: translucent fields, only on the submaps that have any.
+    for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
+        for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            const submap *const cur_submap = get_submap_at_grid( {smx, smy, zlev} );
+            if( cur_submap->is_uniform || cur_submap->field_count == 0 ) {
+                continue;
+            }
+            for( int sx = 0; sx < SEEX; ++sx ) {
+                for( int sy = 0; sy < SEEY; ++sy ) {
+                    float &value = transparency_cache[sx + smx * SEEX][sy + smy * SEEY];
+                    if( value == solid ) {
                         continue;
                     }
                     for( const auto &fld : cur_submap->get_field( { sx, sy } ) ) {
@@ -333,6 +358,7 @@ void map::build_sunlight_cache( int zlev )
 
 void map::generate_lightmap( const int zlev )
 {
+    CATA_PROFILE_ZONE( "map::generate_lightmap" );
     auto &map_cache = get_cache( zlev );
     auto &lm = map_cache.lm;
     auto &sm = map_cache.sm;
@@ -351,6 +377,8 @@ void map::generate_lightmap( const int zlev )
      */
     auto &light_source_buffer = map_cache.light_source_buffer;
     std::memset( light_source_buffer, 0, sizeof( light_source_buffer ) );
+    // The buffered sources' shadowcasts are kept between calls, see apply_buffered_light_source.
+    invalidate_light_source_casts( zlev );
 
     constexpr std::array<int, 4> dir_x = { {  0, -1, 1, 0 } };    //    [0]
     constexpr std::array<int, 4> dir_y = { { -1,  0, 0, 1 } };    // [1][X][2]
@@ -381,7 +409,7 @@ void map::generate_lightmap( const int zlev )
     // Traverse the submaps in order
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            const auto cur_submap = get_submap_at_grid( { smx, smy, zlev } );
+            const submap *const cur_submap = get_submap_at_grid( { smx, smy, zlev } );
 
             for( int sx = 0; sx < SEEX; ++sx ) {
                 for( int sy = 0; sy < SEEY; ++sy ) {
@@ -424,7 +452,7 @@ void map::generate_lightmap( const int zlev )
                         add_light_source( p, furniture->light_emitted );
                     }
 
-                    for( auto &fld : cur_submap->get_field( { sx, sy } ) ) {
+                    for( const auto &fld : cur_submap->get_field( { sx, sy } ) ) {
                         const field_entry *cur = &fld.second;
                         const int light_emitted = cur->light_emitted();
                         if( light_emitted > 0 ) {
@@ -533,7 +561,17 @@ void map::generate_lightmap( const int zlev )
     const tripoint cache_end( LIGHTMAP_CACHE_X, LIGHTMAP_CACHE_Y, zlev );
     for( const tripoint &p : points_in_rectangle( cache_start, cache_end ) ) {
         if( light_source_buffer[p.x][p.y] > 0.0 ) {
-            apply_light_source( p, light_source_buffer[p.x][p.y] );
+            apply_buffered_light_source( p, light_source_buffer[p.x][p.y] );
+        }
+    }
+    // Forget the sources that went out.
+    auto &casts_cache = map_cache.light_source_casts_cache;
+    for( auto it = casts_cache.begin(); it != casts_cache.end(); ) {
+        if( it->second.used ) {
+            it->second.used = false;
+            ++it;
+        } else {
+            it = casts_cache.erase( it );
         }
     }
 
@@ -669,7 +707,8 @@ lit_level map::apparent_light_at( const tripoint &p, const visibility_variables
     if( cache.u_clairvoyance > 0 && dist <= cache.u_clairvoyance ) {
         return LL_BRIGHT;
     }
-    const field_type_str_id fd_clairvoyant( "fd_clairvoyant" );
+    // This is called for every tile of the map, so don't look the id up every time.
+    static const field_type_str_id fd_clairvoyant( "fd_clairvoyant" );
     if( fd_clairvoyant.is_valid() && field_at( p ).find_field( fd_clairvoyant ) ) {
         return LL_BRIGHT;
     }
@@ -966,6 +1005,21 @@ void cast_zlight_segment(
     }
 }
 
+// Casts one of the segments of cast_zlight, starting at the origin.
+template<int xx, int xy, int xz, int yx, int yy, int yz, int zz, typename T,
+         T( *calc )( const T &, const T &, const int & ),
+         bool( *check )( const T &, const T & ),
+         T( *accumulate )( const T &, const T &, const int & )>
+void cast_zlight_from_origin(
+    const array_of_grids_of<T> &output_caches,
+    const array_of_grids_of<const T> &input_arrays,
+    const array_of_grids_of<const bool> &floor_caches,
+    const tripoint &origin, const int offset_distance, const T numerator )
+{
+    cast_zlight_segment<xx, xy, xz, yx, yy, yz, zz, T, calc, check, accumulate>(
+        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+}
+
 template<typename T, T( *calc )( const T &, const T &, const int & ),
          bool( *check )( const T &, const T & ),
          T( *accumulate )( const T &, const T &, const int & )>
@@ -975,47 +1029,94 @@ void cast_zlight(
     const array_of_grids_of<const bool> &floor_caches,
     const tripoint &origin, const int offset_distance, const T numerator )
 {
-    // Down
-    cast_zlight_segment < 0, 1, 0, 1, 0, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < 1, 0, 0, 0, 1, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+    using segment_function = void( * )( const array_of_grids_of<T> &,
+                                        const array_of_grids_of<const T> &,
+                                        const array_of_grids_of<const bool> &,
+                                        const tripoint &, int, T );
+    static constexpr std::array<segment_function, 16> segments = {{
+            // Down
+            cast_zlight_from_origin < 0, 1, 0, 1, 0, 0, -1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < 1, 0, 0, 0, 1, 0, -1, T, calc, check, accumulate >,
 
-    cast_zlight_segment < 0, -1, 0, 1, 0, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < -1, 0, 0, 0, 1, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, -1, 0, 1, 0, 0, -1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < -1, 0, 0, 0, 1, 0, -1, T, calc, check, accumulate >,
 
-    cast_zlight_segment < 0, 1, 0, -1, 0, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < 1, 0, 0, 0, -1, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, 1, 0, -1, 0, 0, -1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < 1, 0, 0, 0, -1, 0, -1, T, calc, check, accumulate >,
 
-    cast_zlight_segment < 0, -1, 0, -1, 0, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < -1, 0, 0, 0, -1, 0, -1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, -1, 0, -1, 0, 0, -1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < -1, 0, 0, 0, -1, 0, -1, T, calc, check, accumulate >,
 
-    // Up
-    cast_zlight_segment<0, 1, 0, 1, 0, 0, 1, T, calc, check, accumulate>(
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment<1, 0, 0, 0, 1, 0, 1, T, calc, check, accumulate>(
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            // Up
+            cast_zlight_from_origin<0, 1, 0, 1, 0, 0, 1, T, calc, check, accumulate>,
+            cast_zlight_from_origin<1, 0, 0, 0, 1, 0, 1, T, calc, check, accumulate>,
 
-    cast_zlight_segment < 0, -1, 0, 1, 0, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < -1, 0, 0, 0, 1, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, -1, 0, 1, 0, 0, 1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < -1, 0, 0, 0, 1, 0, 1, T, calc, check, accumulate >,
 
-    cast_zlight_segment < 0, 1, 0, -1, 0, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < 1, 0, 0, 0, -1, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, 1, 0, -1, 0, 0, 1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < 1, 0, 0, 0, -1, 0, 1, T, calc, check, accumulate >,
 
-    cast_zlight_segment < 0, -1, 0, -1, 0, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
-    cast_zlight_segment < -1, 0, 0, 0, -1, 0, 1, T, calc, check, accumulate > (
-        output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+            cast_zlight_from_origin < 0, -1, 0, -1, 0, 0, 1, T, calc, check, accumulate >,
+            cast_zlight_from_origin < -1, 0, 0, 0, -1, 0, 1, T, calc, check, accumulate >,
+        }
+    };
+
+    thread_pool &pool = shared_thread_pool();
+    const int segment_count = static_cast<int>( segments.size() );
+    const int chunks = std::min( segment_count, static_cast<int>( pool.size() ) + 1 );
+    if( chunks <= 1 ) {
+        for( const segment_function segment : segments ) {
+            segment( output_caches, input_arrays, floor_caches, origin, offset_distance, numerator );
+        }
+        return;
+    }
+
+    // The segments only overlap at their borders, but they do overlap, so every chunk of
+    // consecutive segments is cast into grids of its own. Those get merged into the output in
+    // chunk order, which gives exactly the same maxima as casting all segments in order.
+    // The grids start at zero, so this relies on the output never being below zero.
+    // Segments don't reach further up or down than fov_3d_z_range.
+    const int min_z = std::max( origin.z - fov_3d_z_range, -OVERMAP_DEPTH );
+    const int max_z = std::min( origin.z + fov_3d_z_range, OVERMAP_HEIGHT );
+    const int layers = max_z - min_z + 1;
+
+    using grid = T[MAPSIZE_X][MAPSIZE_Y];
+    // Kept zeroed between calls, this is only ever called from the main thread.
+    static std::unique_ptr<grid[]> chunk_grids;
+    static int chunk_grids_count = 0;
+    if( chunk_grids_count < chunks * layers ) {
+        chunk_grids_count = chunks * layers;
+        chunk_grids.reset( new grid[chunk_grids_count]() );
+    }
+
+    pool.parallel_for( 0, chunks, [&]( const int chunk ) {
+        array_of_grids_of<T> chunk_outputs{};
+        for( int z = min_z; z <= max_z; z++ ) {
+            chunk_outputs[z + OVERMAP_DEPTH] = &chunk_grids[chunk * layers + z - min_z];
+        }
+        const int first = chunk * segment_count / chunks;
+        const int last = ( chunk + 1 ) * segment_count / chunks;
+        for( int i = first; i < last; i++ ) {
+            segments[i]( chunk_outputs, input_arrays, floor_caches, origin, offset_distance, numerator );
+        }
+    } );
+
+    const T zero = 0.0f;
+    pool.parallel_for( 0, layers, [&]( const int layer ) {
+        grid &output = *output_caches[min_z + layer + OVERMAP_DEPTH];
+        for( int chunk = 0; chunk < chunks; chunk++ ) {
+            grid &cast = chunk_grids[chunk * layers + layer];
+            for( int x = 0; x < MAPSIZE_X; x++ ) {
+                for( int y = 0; y < MAPSIZE_Y; y++ ) {
+                    if( zero < cast[x][y] ) {
+                        output[x][y] = std::max( output[x][y], cast[x][y] );
+                    }
+                    cast[x][y] = zero;
+                }
+            }
+        }
+    } );
 }
 
 // I can't figure out how to make implicit instantiation work when the parameters of
@@ -1318,24 +1419,34 @@ static bool light_check( const float &transparency, const float &intensity )
     return transparency > LIGHT_TRANSPARENCY_SOLID && intensity > LIGHT_AMBIENT_LOW;
 }
 
-void map::apply_light_source( const tripoint &p, float luminance )
+// Directions a light source casts rays into, see light_source_directions.
+static constexpr int light_north = 1;
+static constexpr int light_east = 2;
+static constexpr int light_south = 4;
+static constexpr int light_west = 8;
+
+/**
+ * Lights the tile of a light source itself and returns the directions it still has to cast
+ * rays into, or 0 if it is too weak to light anything else.
+ * @param luminance Gets adjusted to the luminance the rays should be cast with.
+ */
+static int light_source_directions( level_cache &cache, const point &p, const bool in_bounds,
+                                    float &luminance )
 {
-    auto &cache = get_cache( p.z );
     four_quadrants( &lm )[MAPSIZE_X][MAPSIZE_Y] = cache.lm;
     float ( &sm )[MAPSIZE_X][MAPSIZE_Y] = cache.sm;
-    float ( &transparency_cache )[MAPSIZE_X][MAPSIZE_Y] = cache.transparency_cache;
     float ( &light_source_buffer )[MAPSIZE_X][MAPSIZE_Y] = cache.light_source_buffer;
 
     const int x = p.x;
     const int y = p.y;
 
-    if( inbounds( p ) ) {
+    if( in_bounds ) {
         const float min_light = std::max( static_cast<float>( LL_LOW ), luminance );
         lm[x][y] = elementwise_max( lm[x][y], min_light );
         sm[x][y] = std::max( sm[x][y], luminance );
     }
     if( luminance <= LL_LOW ) {
-        return;
+        return 0;
     } else if( luminance <= LL_BRIGHT_ONLY ) {
         luminance = 1.49f;
     }
@@ -1357,46 +1468,148 @@ void map::apply_light_source( const tripoint &p, float luminance )
            sy
     */
     const int peer_inbounds = LIGHTMAP_CACHE_X - 1;
-    bool north = ( y != 0 && light_source_buffer[x][y - 1] < luminance );
-    bool south = ( y != peer_inbounds && light_source_buffer[x][y + 1] < luminance );
-    bool east = ( x != peer_inbounds && light_source_buffer[x + 1][y] < luminance );
-    bool west = ( x != 0 && light_source_buffer[x - 1][y] < luminance );
+    int directions = 0;
+    if( y != 0 && light_source_buffer[x][y - 1] < luminance ) {
+        directions |= light_north;
+    }
+    if( x != peer_inbounds && light_source_buffer[x + 1][y] < luminance ) {
+        directions |= light_east;
+    }
+    if( y != peer_inbounds && light_source_buffer[x][y + 1] < luminance ) {
+        directions |= light_south;
+    }
+    if( x != 0 && light_source_buffer[x - 1][y] < luminance ) {
+        directions |= light_west;
+    }
+    return directions;
+}
 
-    if( north ) {
+static void cast_light_source( four_quadrants( &lm )[MAPSIZE_X][MAPSIZE_Y],
+                               const float ( &transparency_cache )[MAPSIZE_X][MAPSIZE_Y],
+                               const point &p, const float luminance, const int directions )
+{
+    if( directions & light_north ) {
         castLight < 1, 0, 0, -1, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
         castLight < -1, 0, 0, -1, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
     }
 
-    if( east ) {
+    if( directions & light_east ) {
         castLight < 0, -1, 1, 0, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
         castLight < 0, -1, -1, 0, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
     }
 
-    if( south ) {
+    if( directions & light_south ) {
         castLight<1, 0, 0, 1, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency>(
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
         castLight < -1, 0, 0, 1, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
     }
 
-    if( west ) {
+    if( directions & light_west ) {
         castLight<0, 1, 1, 0, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency>(
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
         castLight < 0, 1, -1, 0, float, four_quadrants, light_calc, light_check,
                   update_light_quadrants, accumulate_transparency > (
-                      lm, transparency_cache, point( x, y ), 0, luminance );
+                      lm, transparency_cache, p, 0, luminance );
+    }
+}
+
+void map::apply_light_source( const tripoint &p, float luminance )
+{
+    auto &cache = get_cache( p.z );
+    const int directions = light_source_directions( cache, p.xy(), inbounds( p ), luminance );
+    cast_light_source( cache.lm, cache.transparency_cache, p.xy(), luminance, directions );
+}
+
+void map::apply_buffered_light_source( const tripoint &p, float luminance )
+{
+    auto &cache = get_cache( p.z );
+    light_source_key key{ p.xy(), luminance, 0 };
+    key.directions = light_source_directions( cache, p.xy(), inbounds( p ), luminance );
+    if( key.directions == 0 ) {
+        return;
+    }
+
+    auto &casts_cache = cache.light_source_casts_cache;
+    auto found = casts_cache.find( key );
+    if( found == casts_cache.end() ) {
+        // Cast into an empty lightmap to see what this source lights on its own.
+        static four_quadrants source_lm[MAPSIZE_X][MAPSIZE_Y];
+        cast_light_source( source_lm, cache.transparency_cache, p.xy(), luminance, key.directions );
+        // The light falls off at least with the distance (see light_calc) and the cast stops
+        // one row after it drops to LIGHT_AMBIENT_LOW, so only this square can have been lit.
+        const int range = std::min( 60, static_cast<int>( luminance / LIGHT_AMBIENT_LOW ) + 1 );
+        const point lit_min( std::max( 0, p.x - range ), std::max( 0, p.y - range ) );
+        const point lit_max( std::min( MAPSIZE_X - 1, p.x + range ),
+                             std::min( MAPSIZE_Y - 1, p.y + range ) );
+        light_source_casts casts;
+        casts.min = point( MAPSIZE_X, MAPSIZE_Y );
+        casts.max = point( -1, -1 );
+        for( int x = lit_min.x; x <= lit_max.x; x++ ) {
+            for( int y = lit_min.y; y <= lit_max.y; y++ ) {
+                if( source_lm[x][y].max() <= 0.0f ) {
+                    continue;
+                }
+                casts.tiles.emplace_back( x * MAPSIZE_Y + y, source_lm[x][y] );
+                casts.min = point( std::min( casts.min.x, x ), std::min( casts.min.y, y ) );
+                casts.max = point( std::max( casts.max.x, x ), std::max( casts.max.y, y ) );
+                source_lm[x][y].fill( 0.0f );
+            }
+        }
+        found = casts_cache.emplace( key, std::move( casts ) ).first;
+    }
+    found->second.used = true;
+
+    four_quadrants( &lm )[MAPSIZE_X][MAPSIZE_Y] = cache.lm;
+    for( const std::pair<int, four_quadrants> &tile : found->second.tiles ) {
+        four_quadrants &light = lm[tile.first / MAPSIZE_Y][tile.first % MAPSIZE_Y];
+        light = elementwise_max( light, tile.second );
+    }
+}
+
+void map::invalidate_light_source_casts( const int zlev )
+{
+    auto &cache = get_cache( zlev );
+    const auto &transparency_cache = cache.transparency_cache;
+    auto &cast_transparency = cache.light_source_transparency;
+    if( std::memcmp( cast_transparency, transparency_cache, sizeof( transparency_cache ) ) == 0 ) {
+        return;
+    }
+
+    auto &casts_cache = cache.light_source_casts_cache;
+    if( !casts_cache.empty() ) {
+        // changed[x][y] is the number of changed tiles left of x and above y, so the changes
+        // in any rectangle can be counted without looking at its tiles.
+        static int changed[MAPSIZE_X + 1][MAPSIZE_Y + 1];
+        for( int x = 0; x < MAPSIZE_X; x++ ) {
+            for( int y = 0; y < MAPSIZE_Y; y++ ) {
+                changed[x + 1][y + 1] = changed[x][y + 1] + changed[x + 1][y] - changed[x][y] +
+                                        ( cast_transparency[x][y] != transparency_cache[x][y] ? 1 : 0 );
+            }
+        }
+        for( auto it = casts_cache.begin(); it != casts_cache.end(); ) {
+            const point &min = it->second.min;
+            const point &max = it->second.max;
+            if( min.x <= max.x && changed[max.x + 1][max.y + 1] - changed[min.x][max.y + 1] -
+                changed[max.x + 1][min.y] + changed[min.x][min.y] > 0 ) {
+                it = casts_cache.erase( it );
+            } else {
+                ++it;
+            }
+        }
     }
+    std::memcpy( cast_transparency, transparency_cache, sizeof( transparency_cache ) );
 }
 
 void map::apply_directional_light( const tripoint &p, int direction, float luminance )
@@ -17,6 +17,8 @@
 #include <utility>
 #include <vector>
 #include <csignal>
+#include "background_save.h"
+#include "benchmark.h"
 #include "color.h"
 #include "crash.h"
 #include "cursesdef.h"
@@ -66,6 +68,7 @@ int main( int argc, char *argv[] )
     int seed = time( nullptr );
     bool verifyexit = false;
     bool check_mods = false;
+    int bench_turns = 0;
     std::string dump;
     dump_mode dmode = dump_mode::TSV;
     std::vector<std::string> opts;
@@ -80,7 +83,7 @@ int main( int argc, char *argv[] )
         const char *section_default = nullptr;
         const char *section_map_sharing = "Map sharing";
         const char *section_user_directory = "User directories";
-        const std::array<arg_handler, 12> first_pass_arguments = {{
+        const std::array<arg_handler, 13> first_pass_arguments = {{
                 {
                     "--seed", "<string of letters and or numbers>",
                     "Sets the random number generator's seed value",
@@ -118,6 +121,24 @@ int main( int argc, char *argv[] )
                         return 0;
                     }
                 },
+                {
+                    "--bench-turns", "<turns>",
+                    "Runs the given number of turns in a throwaway world and prints their timings as JSON",
+                    section_default,
+                    [&bench_turns]( int num_args, const char **params ) -> int {
+                        if( num_args < 1 )
+                        {
+                            return -1;
+                        }
+                        bench_turns = atoi( params[0] );
+                        if( bench_turns <= 0 )
+                        {
+                            return -1;
+                        }
+                        test_mode = true;
+                        return 1;
+                    }
+                },
                 {
                     "--dump-stats", "<what> [mode = TSV] [opts…]",
                     "Dumps item stats",
@@ -521,6 +542,15 @@ int main( int argc, char *argv[] )
             const std::vector<mod_id> mods( opts.begin(), opts.end() );
             exit( g->check_mod_data( mods, ui ) && !debug_has_error_been_observed() ? 0 : 1 );
         }
+        if( bench_turns > 0 ) {
+#if defined(TILES)
+            // Normally loaded by catacurses::init_interface, which is skipped in test mode.
+            get_options().init();
+            get_options().load();
+#endif
+            init_colors();
+            exit( benchmark::run_turns( bench_turns, std::cout ) ? 0 : 1 );
+        }
     } catch( const std::exception &err ) {
         debugmsg( "%s", err.what() );
         exit_handler( -999 );
@@ -637,6 +667,7 @@ void exit_handler( int s )
     if( s != 2 || query_yn( _( "Really Quit?  All unsaved changes will be lost." ) ) ) {
         catacurses::erase(); // Clear screen
 
+        background_save::wait();
         deinitDebug();
 
         int exit_status = 0;
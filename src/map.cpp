@@ -9,6 +9,7 @@
 #include <limits>
 #include <queue>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "ammo.h"
 #include "ammo_effect.h"
@@ -46,13 +47,16 @@
 #include "output.h"
 #include "overmapbuffer.h"
 #include "pathfinding.h"
+#include "profiler.h"
 #include "projectile.h"
 #include "rng.h"
 #include "safe_reference.h"
 #include "scent_map.h"
+#include "sight_cache.h"
 #include "sounds.h"
 #include "string_formatter.h"
 #include "submap.h"
+#include "thread_pool.h"
 #include "timed_event.h"
 #include "translations.h"
 #include "trap.h"
@@ -1499,6 +1503,8 @@ bool map::ter_set( const tripoint &p, const ter_id &new_terrain )
     }
 
     current_submap->set_ter( l, new_terrain );
+    // Dormant fields don't notice the terrain changing below them.
+    current_submap->wake_fields( l );
 
     // Set the dirty flags
     const ter_t &old_t = old_id.obj();
@@ -5132,7 +5138,8 @@ const field &map::field_at( const tripoint &p ) const
     }
 
     point l;
-    submap *const current_submap = get_submap_at( p, l );
+    // Reading the fields must not wake up dormant ones.
+    const submap *const current_submap = get_submap_at( p, l );
 
     return current_submap->get_field( l );
 }
@@ -5925,6 +5932,61 @@ void map::draw_from_above( const catacurses::window &w, const player &u, const t
     }
 }
 
+point map::sight_line_key( const tripoint &F, const tripoint &T )
+{
+    // Cannonicalize the order of the tripoints so the cache is reflexive.
+    const tripoint &min = F < T ? F : T;
+    const tripoint &max = !( F < T ) ? F : T;
+    // A little gross, just pack the values into a point.
+    return point( min.x << 16 | min.y << 8 | min.z, max.x << 16 | max.y << 8 | max.z );
+}
+
+bool map::sight_line_is_clear( const tripoint &F, const tripoint &T, int &bresenham_slope ) const
+{
+    bool visible = true;
+    bresenham( F.xy(), T.xy(), bresenham_slope,
+    [this, &visible, &T]( const point & new_point ) {
+        // Exit before checking the last square, it's still visible even if opaque.
+        if( new_point.x == T.x && new_point.y == T.y ) {
+            return false;
+        }
+        if( !this->is_transparent( tripoint( new_point, T.z ) ) ) {
+            visible = false;
+            return false;
+        }
+        return true;
+    } );
+    return visible;
+}
+
+void map::prefetch_sight_lines( const std::vector<std::pair<tripoint, tripoint>> &lines )
+{
+    // The lines that are not cached yet, each one only once.
+    std::vector<std::pair<tripoint, tripoint>> missing;
+    std::unordered_set<point> keys;
+    for( const std::pair<tripoint, tripoint> &line : lines ) {
+        if( line.first.z != line.second.z || !inbounds( line.first ) || !inbounds( line.second ) ) {
+            continue;
+        }
+        const point key = sight_line_key( line.first, line.second );
+        if( skew_vision_cache.get( key, -1 ) < 0 && keys.insert( key ).second ) {
+            missing.push_back( line );
+        }
+    }
+
+    // The workers only read the transparency cache, the cache is filled afterwards
+    // in the order of the lines.
+    std::vector<char> visible( missing.size() );
+    shared_thread_pool().parallel_for( 0, static_cast<int>( missing.size() ), [&]( const int i ) {
+        int bresenham_slope = 0;
+        visible[i] = sight_line_is_clear( missing[i].first, missing[i].second, bresenham_slope );
+    } );
+    for( size_t i = 0; i < missing.size(); i++ ) {
+        skew_vision_cache.insert( 100000, sight_line_key( missing[i].first, missing[i].second ),
+                                  visible[i] );
+    }
+}
+
 bool map::sees( const tripoint &F, const tripoint &T, const int range ) const
 {
     int dummy = 0;
@@ -5941,11 +6003,7 @@ bool map::sees( const tripoint &F, const tripoint &T, const int range, int &bres
         bresenham_slope = 0;
         return false; // Out of range!
     }
-    // Cannonicalize the order of the tripoints so the cache is reflexive.
-    const tripoint &min = F < T ? F : T;
-    const tripoint &max = !( F < T ) ? F : T;
-    // A little gross, just pack the values into a point.
-    const point key( min.x << 16 | min.y << 8 | min.z, max.x << 16 | max.y << 8 | max.z );
+    const point key = sight_line_key( F, T );
     char cached = skew_vision_cache.get( key, -1 );
     if( cached >= 0 ) {
         return cached > 0;
@@ -5954,18 +6012,7 @@ bool map::sees( const tripoint &F, const tripoint &T, const int range, int &bres
 
     // Ugly `if` for now
     if( !fov_3d || F.z == T.z ) {
-        bresenham( F.xy(), T.xy(), bresenham_slope,
-        [this, &visible, &T]( const point & new_point ) {
-            // Exit before checking the last square, it's still visible even if opaque.
-            if( new_point.x == T.x && new_point.y == T.y ) {
-                return false;
-            }
-            if( !this->is_transparent( tripoint( new_point, T.z ) ) ) {
-                visible = false;
-                return false;
-            }
-            return true;
-        } );
+        visible = sight_line_is_clear( F, T, bresenham_slope );
         skew_vision_cache.insert( 100000, key, visible ? 1 : 0 );
         return visible;
     }
@@ -6325,6 +6372,7 @@ void map::load( const tripoint &w, const bool update_vehicle )
     }
     field_furn_locs.clear();
     submaps_with_active_items.clear();
+    clear_flow_fields();
     set_abs_sub( w );
     for( int gridx = 0; gridx < my_MAPSIZE; gridx++ ) {
         for( int gridy = 0; gridy < my_MAPSIZE; gridy++ ) {
@@ -6415,6 +6463,8 @@ void map::shift( const point &sp )
 
     g->shift_destination_preview( point( -sp.x * SEEX, -sp.y * SEEY ) );
 
+    clear_flow_fields();
+
     shift_traps( tripoint( sp, 0 ) );
 
     vehicle *remoteveh = g->remoteveh();
@@ -7534,12 +7584,6 @@ void map::build_outside_cache( const int zlev )
         return;
     }
 
-    // Make a bigger cache to avoid bounds checking
-    // We will later copy it to our regular cache
-    const size_t padded_w = ( MAPSIZE_X ) + 2;
-    const size_t padded_h = ( MAPSIZE_Y ) + 2;
-    bool padded_cache[padded_w][padded_h];
-
     auto &outside_cache = ch.outside_cache;
     if( zlev < 0 ) {
         std::uninitialized_fill_n(
@@ -7547,35 +7591,57 @@ void map::build_outside_cache( const int zlev )
         return;
     }
 
-    std::uninitialized_fill_n(
-        &padded_cache[0][0], padded_w * padded_h, true );
+    // A tile is outside unless it or one of its neighbors is indoors.
+    // Find the indoor tiles first, then grow them by one tile along the (contiguous) columns
+    // and then along the rows. Both steps are branch free loops the compiler vectorizes.
+    const int width = SEEX * my_MAPSIZE;
+    const int height = SEEY * my_MAPSIZE;
+    bool indoors[MAPSIZE_X][MAPSIZE_Y];
+    bool near_indoors[MAPSIZE_X][MAPSIZE_Y];
 
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
             const auto cur_submap = get_submap_at_grid( { smx, smy, zlev } );
 
+            if( cur_submap->is_uniform ) {
+                const bool uniform_indoors =
+                    cur_submap->get_ter( point_zero ).obj().has_flag( TFLAG_INDOORS ) ||
+                    cur_submap->get_furn( point_zero ).obj().has_flag( TFLAG_INDOORS );
+                for( int sx = 0; sx < SEEX; ++sx ) {
+                    std::fill_n( &indoors[sx + smx * SEEX][smy * SEEY], SEEY, uniform_indoors );
+                }
+                continue;
+            }
+
             for( int sx = 0; sx < SEEX; ++sx ) {
+                bool *const column = &indoors[sx + smx * SEEX][smy * SEEY];
                 for( int sy = 0; sy < SEEY; ++sy ) {
-                    point sp( sx, sy );
-                    if( cur_submap->get_ter( sp ).obj().has_flag( TFLAG_INDOORS ) ||
-                        cur_submap->get_furn( sp ).obj().has_flag( TFLAG_INDOORS ) ) {
-                        const int x = sx + smx * SEEX;
-                        const int y = sy + smy * SEEY;
-                        // Add 1 to both coordinates, because we're operating on the padded cache
-                        for( int dx = 0; dx <= 2; dx++ ) {
-                            for( int dy = 0; dy <= 2; dy++ ) {
-                                padded_cache[x + dx][y + dy] = false;
-                            }
-                        }
-                    }
+                    const point sp( sx, sy );
+                    column[sy] = cur_submap->get_ter( sp ).obj().has_flag( TFLAG_INDOORS ) ||
+                                 cur_submap->get_furn( sp ).obj().has_flag( TFLAG_INDOORS );
                 }
             }
         }
     }
 
-    // Copy the padded cache back to the proper one, but with no padding
-    for( int x = 0; x < SEEX * my_MAPSIZE; x++ ) {
-        std::copy_n( &padded_cache[x + 1][1], SEEX * my_MAPSIZE, &outside_cache[x][0] );
+    for( int x = 0; x < width; x++ ) {
+        const bool *const in = indoors[x];
+        bool *const out = near_indoors[x];
+        out[0] = in[0] | in[1];
+        for( int y = 1; y < height - 1; y++ ) {
+            out[y] = in[y - 1] | in[y] | in[y + 1];
+        }
+        out[height - 1] = in[height - 2] | in[height - 1];
+    }
+
+    for( int x = 0; x < width; x++ ) {
+        const bool *const prev = near_indoors[std::max( x - 1, 0 )];
+        const bool *const cur = near_indoors[x];
+        const bool *const next = near_indoors[std::min( x + 1, width - 1 )];
+        bool *const out = outside_cache[x];
+        for( int y = 0; y < height; y++ ) {
+            out[y] = !( prev[y] | cur[y] | next[y] );
+        }
     }
 
     ch.outside_cache_dirty = false;
@@ -7689,9 +7755,9 @@ void map::build_floor_caches()
 {
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
     const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
-    for( int z = minz; z <= maxz; z++ ) {
+    shared_thread_pool().parallel_for( minz, maxz + 1, [this]( const int z ) {
         build_floor_cache( z );
-    }
+    } );
 }
 
 void map::do_vehicle_caching( int z )
@@ -7735,19 +7801,28 @@ void map::do_vehicle_caching( int z )
 
 void map::build_map_cache( const int zlev, bool skip_lightmap )
 {
+    CATA_PROFILE_ZONE( "map::build_map_cache" );
     const int minz = zlevels ? -OVERMAP_DEPTH : zlev;
     const int maxz = zlevels ? OVERMAP_HEIGHT : zlev;
-    bool seen_cache_dirty = false;
-    for( int z = minz; z <= maxz; z++ ) {
+    // These caches of a z-level only depend on its own submaps, so the levels are built
+    // concurrently. The vehicle caching touches vehicle state and stays on this thread.
+    std::vector<char> level_dirty( maxz - minz + 1, false );
+    shared_thread_pool().parallel_for( minz, maxz + 1, [&]( const int z ) {
         build_outside_cache( z );
-        seen_cache_dirty |= build_transparency_cache( z );
-        seen_cache_dirty |= build_floor_cache( z );
+        const bool transparency_dirty = build_transparency_cache( z );
+        const bool floor_dirty = build_floor_cache( z );
+        level_dirty[z - minz] = transparency_dirty || floor_dirty;
+    } );
+    bool seen_cache_dirty = std::find( level_dirty.begin(), level_dirty.end(), true ) !=
+                            level_dirty.end();
+    for( int z = minz; z <= maxz; z++ ) {
         do_vehicle_caching( z );
     }
     seen_cache_dirty |= build_vision_transparency_cache( zlev );
 
     if( seen_cache_dirty ) {
         skew_vision_cache.clear();
+        g->creature_sight->invalidate();
     }
     // Initial value is illegal player position.
     const tripoint &p = g->u.pos();
@@ -8057,7 +8132,7 @@ void map::function_over( const tripoint &start, const tripoint &end, Functor fun
 
 void map::scent_blockers( std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &blocks_scent,
                           std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &reduces_scent,
-                          const point &min, const point &max )
+                          const point &min, const point &max, const int z )
 {
     auto reduce = TFLAG_REDUCE_SCENT;
     auto block = TFLAG_WALL;
@@ -8080,7 +8155,7 @@ void map::scent_blockers( std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &bl
         return ITER_CONTINUE;
     };
 
-    function_over( tripoint( min, abs_sub.z ), tripoint( max, abs_sub.z ), fill_values );
+    function_over( tripoint( min, z ), tripoint( max, z ), fill_values );
 
     const rectangle local_bounds( min, max );
 
@@ -8091,7 +8166,7 @@ void map::scent_blockers( std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &bl
         vehicle &veh = *( wrapped_veh.v );
         for( const vpart_reference &vp : veh.get_any_parts( VPFLAG_OBSTACLE ) ) {
             const tripoint part_pos = vp.pos();
-            if( local_bounds.contains_inclusive( part_pos.xy() ) ) {
+            if( part_pos.z == z && local_bounds.contains_inclusive( part_pos.xy() ) ) {
                 reduces_scent[part_pos.x][part_pos.y] = true;
             }
         }
@@ -8103,7 +8178,7 @@ void map::scent_blockers( std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &bl
             }
 
             const tripoint part_pos = vp.pos();
-            if( local_bounds.contains_inclusive( part_pos.xy() ) ) {
+            if( part_pos.z == z && local_bounds.contains_inclusive( part_pos.xy() ) ) {
                 reduces_scent[part_pos.x][part_pos.y] = true;
             }
         }
@@ -8249,6 +8324,7 @@ level_cache::level_cache()
     std::fill_n( &lm[0][0], map_dimensions, four_zeros );
     std::fill_n( &sm[0][0], map_dimensions, 0.0f );
     std::fill_n( &light_source_buffer[0][0], map_dimensions, 0.0f );
+    std::fill_n( &light_source_transparency[0][0], map_dimensions, 0.0f );
     std::fill_n( &outside_cache[0][0], map_dimensions, false );
     std::fill_n( &floor_cache[0][0], map_dimensions, false );
     std::fill_n( &transparency_cache[0][0], map_dimensions, 0.0f );
@@ -8264,6 +8340,7 @@ level_cache::level_cache()
 pathfinding_cache::pathfinding_cache()
 {
     dirty = true;
+    std::fill_n( &special[0][0], MAPSIZE_X * MAPSIZE_Y, PF_NORMAL );
 }
 
 pathfinding_cache::~pathfinding_cache() = default;
@@ -8301,7 +8378,10 @@ void map::update_pathfinding_cache( int zlev ) const
         return;
     }
 
-    std::uninitialized_fill_n( &cache.special[0][0], MAPSIZE_X * MAPSIZE_Y, PF_NORMAL );
+    if( my_MAPSIZE < MAPSIZE ) {
+        // The loops below only cover the submaps of this map.
+        std::uninitialized_fill_n( &cache.special[0][0], MAPSIZE_X * MAPSIZE_Y, PF_NORMAL );
+    }
 
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
@@ -8309,6 +8389,7 @@ void map::update_pathfinding_cache( int zlev ) const
             if( !cur_submap ) {
                 return;
             }
+            bool submap_changed = false;
 
             tripoint p( 0, 0, zlev );
 
@@ -8363,9 +8444,28 @@ void map::update_pathfinding_cache( int zlev ) const
                         cur_value |= PF_SHARP;
                     }
 
+                    submap_changed |= cache.special[p.x][p.y] != cur_value;
                     cache.special[p.x][p.y] = cur_value;
                 }
             }
+
+            if( submap_changed ) {
+                // The entrances on the borders are shared with the neighbors.
+                auto &portals = cache.portals.submaps;
+                portals[smx * MAPSIZE + smy].dirty = true;
+                if( smx > 0 ) {
+                    portals[( smx - 1 ) * MAPSIZE + smy].dirty = true;
+                }
+                if( smx + 1 < my_MAPSIZE ) {
+                    portals[( smx + 1 ) * MAPSIZE + smy].dirty = true;
+                }
+                if( smy > 0 ) {
+                    portals[smx * MAPSIZE + smy - 1].dirty = true;
+                }
+                if( smy + 1 < my_MAPSIZE ) {
+                    portals[smx * MAPSIZE + smy + 1].dirty = true;
+                }
+            }
         }
     }
 
@@ -90,7 +90,9 @@ using items_location = std::string;
 class map;
 
 enum ter_bitflags : int;
+enum pf_special : int;
 struct pathfinding_cache;
+struct pathfinding_flow_field;
 struct pathfinding_settings;
 template<typename T>
 struct weighted_int_list;
@@ -153,6 +155,33 @@ struct bash_params {
     bool bashing_from_above;
 };
 
+/** Identifies the shadowcasts of a buffered light source, see @ref map::add_light_source. */
+struct light_source_key {
+    point pos;
+    float luminance;
+    /** Bit mask of the directions rays were cast into. */
+    int directions;
+
+    bool operator<( const light_source_key &rhs ) const {
+        return std::tie( pos, luminance, directions ) <
+               std::tie( rhs.pos, rhs.luminance, rhs.directions );
+    }
+};
+
+/** The light a buffered light source cast onto the tiles around it. */
+struct light_source_casts {
+    /** Lit tiles as x * MAPSIZE_Y + y, with the light they got. */
+    std::vector<std::pair<int, four_quadrants>> tiles;
+    /**
+     * Bounding box of the lit tiles. Shadowcasting only looks at the transparency of tiles
+     * it also lights, so the casts stay valid until a tile in here changes.
+     */
+    point min;
+    point max;
+    /** Whether the source was still there in the last generate_lightmap. */
+    bool used = false;
+};
+
 struct level_cache {
     // Zeros all relevant values
     level_cache();
@@ -167,6 +196,11 @@ struct level_cache {
     // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
     // This is only valid for the duration of generate_lightmap
     float light_source_buffer[MAPSIZE_X][MAPSIZE_Y];
+    // Shadowcasts of the buffered light sources, reused by generate_lightmap as long as
+    // nothing they cover changes. Only the sources that are still there are kept.
+    std::map<light_source_key, light_source_casts> light_source_casts_cache;
+    // The transparency_cache the cached shadowcasts were made with.
+    float light_source_transparency[MAPSIZE_X][MAPSIZE_Y];
     bool outside_cache[MAPSIZE_X][MAPSIZE_Y];
     bool floor_cache[MAPSIZE_X][MAPSIZE_Y];
     float transparency_cache[MAPSIZE_X][MAPSIZE_Y];
@@ -463,7 +497,21 @@ class map
         * Returns whether `F` sees `T` with a view range of `range`.
         */
         bool sees( const tripoint &F, const tripoint &T, int range ) const;
+        /**
+         * Works out the lines of sight between the given pairs of points on worker threads
+         * and stores them in the cache that @ref sees uses, so later calls for them do not
+         * walk the lines again. Only pairs on the same z-level are handled.
+         * The transparency cache must be up to date.
+         */
+        void prefetch_sight_lines( const std::vector<std::pair<tripoint, tripoint>> &lines );
     private:
+        /** Key of the line between the points in @ref skew_vision_cache, the same in both directions. */
+        static point sight_line_key( const tripoint &F, const tripoint &T );
+        /**
+         * Whether nothing opaque is on the line from @p F to @p T (on the z-level of @p T).
+         * This only reads the transparency cache, so it can run on any thread.
+         */
+        bool sight_line_is_clear( const tripoint &F, const tripoint &T, int &bresenham_slope ) const;
         /**
          * Don't expose the slope adjust outside map functions.
          *
@@ -541,6 +589,39 @@ class map
         std::vector<tripoint> route( const tripoint &f, const tripoint &t,
                                      const pathfinding_settings &settings,
         const std::set<tripoint> &pre_closed = {{ }} ) const;
+        /**
+         * Same as @ref route for creatures that don't avoid any extra points, but the search
+         * is shared by everyone heading for @p t with the same movement costs during the current
+         * turn, like a horde chasing the avatar. The first call is a normal @ref route, the
+         * second one finds the way to @p t from every tile of its z-level and the later ones
+         * just follow it.
+         */
+        std::vector<tripoint> shared_route( const tripoint &f, const tripoint &t,
+                                            const pathfinding_settings &settings ) const;
+    private:
+        /**
+         * Extra cost for @ref route of stepping from @p cur onto @p p, which has the flags
+         * @p p_special set (some of them unusual). -1 if the step isn't possible, then @p close
+         * is set if it isn't possible from anywhere else either and @p ledge if the way past @p p
+         * is dropping down the ledge there.
+         */
+        int route_special_cost( const tripoint &cur, const tripoint &p, pf_special p_special,
+                                const pathfinding_settings &settings, bool &close, bool &ledge ) const;
+        /** Finds the way to @p t from every tile of its z-level, see @ref shared_route. */
+        std::unique_ptr<pathfinding_flow_field> build_flow_field( const tripoint &t,
+                const pathfinding_settings &settings ) const;
+        /** Forgets everything @ref shared_route found, the flow fields are in local coordinates. */
+        void clear_flow_fields() const;
+        /**
+         * The A* search of @ref route, limited to x and y from @p min up to (but excluding) @p max,
+         * to z-levels from min.z to max.z and, unless it's null, to the submaps in @p corridor.
+         */
+        std::vector<tripoint> route_in_area( const tripoint &f, const tripoint &t,
+                                             const pathfinding_settings &settings,
+                                             const std::set<tripoint> &pre_closed,
+                                             const tripoint &min, const tripoint &max,
+                                             const std::bitset<MAPSIZE *MAPSIZE> *corridor ) const;
+    public:
 
         // Vehicles: Common to 2D and 3D
         VehicleList get_vehicles();
@@ -1261,12 +1342,12 @@ class map
 
         // Scent propagation helpers
         /**
-         * Build the map of scent-resistant tiles.
+         * Build the map of scent-resistant tiles on z-level @p z.
          * Should be way faster than if done in `game.cpp` using public map functions.
          */
         void scent_blockers( std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &blocks_scent,
                              std::array<std::array<bool, MAPSIZE_X>, MAPSIZE_Y> &reduces_scent,
-                             const point &min, const point &max );
+                             const point &min, const point &max, int z );
 
         // Computers
         computer *computer_at( const tripoint &p );
@@ -1678,6 +1759,11 @@ class map
         // ...this, which will apply the light after at the end of generate_lightmap, and prevent redundant
         // light rays from causing massive slowdowns, if there's a huge amount of light.
         void add_light_source( const tripoint &p, float luminance );
+        // Applies a light source from the buffer, reusing its shadowcasts from the last
+        // generate_lightmap if none of the tiles they cover became more or less transparent.
+        void apply_buffered_light_source( const tripoint &p, float luminance );
+        // Drops the cached shadowcasts that cover tiles whose transparency changed.
+        void invalidate_light_source_casts( int zlev );
         // Handle just cardinal directions and 45 deg angles.
         void apply_directional_light( const tripoint &p, int direction, float luminance );
         void apply_light_arc( const tripoint &p, int angle, float luminance, int wideangle = 30 );
@@ -1765,6 +1851,11 @@ class map
         std::array< std::unique_ptr<level_cache>, OVERMAP_LAYERS > caches;
 
         mutable std::array< std::unique_ptr<pathfinding_cache>, OVERMAP_LAYERS > pathfinding_caches;
+        /** Flow fields of @ref shared_route, only valid during @ref flow_fields_turn. */
+        mutable std::vector<std::unique_ptr<pathfinding_flow_field>> flow_fields;
+        /** Goals @ref shared_route was asked for once during @ref flow_fields_turn. */
+        mutable std::vector<std::pair<tripoint, pathfinding_settings>> flow_field_requests;
+        mutable time_point flow_fields_turn;
         /**
          * Set of submaps that contain active items in absolute coordinates.
          */
@@ -1,4 +1,5 @@
 #include <array>
+#include <climits>
 #include <cmath>
 #include <cstddef>
 #include <algorithm>
@@ -374,6 +375,45 @@ void map::create_hot_air( const tripoint &p, int intensity )
     }
 }
 
+/**
+ * Number of turns the fields on a tile can skip processing, because all they would do
+ * during those is to grow older. 0 if they need to be processed every turn.
+ * Mirrors what @ref map::process_fields_in_submap does with a field entry.
+ */
+static int field_dormant_turns( field &curfield, const ter_t &ter )
+{
+    // Sleeping any shorter costs more than processing the fields.
+    static constexpr int min_dormant_turns = 10;
+    int dormant_turns = INT_MAX;
+    for( auto &fp : curfield ) {
+        field_entry &cur = fp.second;
+        const field_type_id type = cur.get_field_type();
+        const field_type &fdata = type.obj();
+        if( type == fd_acid || type == fd_fire || type == fd_fungal_haze || type == fd_fire_vent ||
+            type == fd_flame_burst || type == fd_electricity || type == fd_push_items ||
+            type == fd_shock_vent || type == fd_acid_vent || type == fd_bees || type == fd_incendiary ||
+            type == fd_rubble || type == fd_fungicidal_gas ) {
+            return 0;
+        }
+        if( !cur.is_field_alive() || cur.gas_can_spread() || fdata.dirty_transparency_cache ||
+            cur.intensity_upgrade_chance() > 0 || fdata.apply_slime_factor > 0 ||
+            std::get<0>( fdata.npc_complain_data ) > 0 || cur.extra_radiation_max() > 0 ||
+            fdata.wandering_field.is_valid() ||
+            ( cur.monster_spawn_count() > 0 && cur.monster_spawn_chance() > 0 ) ) {
+            return 0;
+        }
+        if( ter.has_flag( TFLAG_SWIMMABLE ) && cur.get_underwater_age_speedup() != 0_turns ) {
+            return 0;
+        }
+        if( fdata.half_life > 0_turns ) {
+            // The intensity can only drop once dice( 2, age ) may exceed the half life.
+            dormant_turns = std::min( dormant_turns, to_turns<int>( fdata.half_life ) / 2 -
+                                      to_turns<int>( cur.get_field_age() ) );
+        }
+    }
+    return dormant_turns >= min_dormant_turns ? dormant_turns : 0;
+}
+
 /*
 Function: process_fields_in_submap
 Iterates over every field on every tile of the given submap given as parameter.
@@ -400,9 +440,15 @@ bool map::process_fields_in_submap( submap *const current_submap,
     maptile map_tile( current_submap, 0, 0 );
     size_t &locx = map_tile.x;
     size_t &locy = map_tile.y;
+    current_submap->start_field_processing();
     // Loop through all tiles in this submap indicated by current_submap
     for( locx = 0; locx < SEEX; locx++ ) {
         for( locy = 0; locy < SEEY; locy++ ) {
+            const point loc( static_cast<int>( locx ), static_cast<int>( locy ) );
+            // Skip the tiles without fields and the ones whose fields are dormant.
+            if( !current_submap->field_processing_due( loc ) ) {
+                continue;
+            }
             // This is a translation from local coordinates to submap coordinates.
             // All submaps are in one long 1d array.
             thep.x = locx + submap.x * SEEX;
@@ -411,7 +457,7 @@ bool map::process_fields_in_submap( submap *const current_submap,
             const tripoint &p = thep;
             // Get a reference to the field variable from the submap;
             // contains all the pointers to the real field effects.
-            field &curfield = current_submap->get_field( { static_cast<int>( locx ), static_cast<int>( locy ) } );
+            field &curfield = current_submap->get_field( loc );
             for( auto it = curfield.begin(); it != curfield.end(); ) {
                 // Iterating through all field effects in the submap's field.
                 field_entry &cur = it->second;
@@ -1312,8 +1358,11 @@ bool map::process_fields_in_submap( submap *const current_submap,
                     ++it;
                 }
             }
+            current_submap->finish_field_processing( loc, field_dormant_turns( curfield,
+                    map_tile.get_ter_t() ) );
         }
     }
+    current_submap->end_field_processing();
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
     const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
     for( int z = std::max( submap.z - 1, minz ); z <= std::min( submap.z + 1, maxz ); ++z ) {
@@ -1,13 +1,17 @@
 #include "mapbuffer.h"
 
 #include <algorithm>
+#include <array>
 #include <exception>
 #include <functional>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "background_save.h"
+#include "binary_io.h"
 #include "cata_utility.h"
 #include "coordinate_conversions.h"
 #include "debug.h"
@@ -15,9 +19,12 @@
 #include "game.h"
 #include "json.h"
 #include "map.h"
+#include "options.h"
 #include "output.h"
+#include "region_file.h"
 #include "submap.h"
 #include "translations.h"
+#include "vehicle.h"
 #include "game_constants.h"
 
 #define dbg(x) DebugLog((x),D_MAP) << __FILE__ << ":" << __LINE__ << ": "
@@ -34,6 +41,62 @@ static std::string find_dirname( const tripoint &om_addr )
                           segment_addr.y, segment_addr.z );
 }
 
+// All quads of a segment are stored in one region file next to the directory that held
+// their separate quad files before.
+static std::string find_region_path( const tripoint &om_addr )
+{
+    return find_dirname( om_addr ) + ".region";
+}
+
+static int find_region_index( const tripoint &om_addr )
+{
+    const tripoint segment_addr = omt_to_seg_copy( om_addr );
+    return ( om_addr.x - segment_addr.x * SEG_SIZE ) * SEG_SIZE + om_addr.y - segment_addr.y * SEG_SIZE;
+}
+
+// Quads in the binary format start with this, JSON quads start with '['.
+static const std::string binary_quad_magic = "CSMB";
+// Version of the binary framing, the content of the submaps has the savegame version.
+static constexpr int binary_quad_version = 1;
+
+static bool is_binary_quad( const std::string &data )
+{
+    return data.compare( 0, binary_quad_magic.size(), binary_quad_magic ) == 0;
+}
+
+static std::array<tripoint, 4> quad_submaps( const tripoint &om_addr )
+{
+    const tripoint origin = omt_to_sm_copy( om_addr );
+    return {{ origin, origin + point_south, origin + point_east, origin + point_south_east }};
+}
+
+// Whether the quad is part of the map around the avatar, the quads outside of it may be unloaded.
+static bool quad_in_map( const tripoint &om_addr )
+{
+    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
+    return ( g->m.has_zlevels() || om_addr.z == g->get_levz() ) &&
+           om_addr.x >= map_origin.x && om_addr.y >= map_origin.y &&
+           om_addr.x <= map_origin.x + HALF_MAPSIZE && om_addr.y <= map_origin.y + HALF_MAPSIZE;
+}
+
+// A rough estimate of the memory owned by a submap, good enough to compare with the budget.
+static size_t estimate_memory( const submap &sm )
+{
+    size_t bytes = sizeof( submap );
+    for( int x = 0; x < SEEX; x++ ) {
+        for( int y = 0; y < SEEY; y++ ) {
+            bytes += sm.get_items( { x, y } ).size() * sizeof( item );
+        }
+    }
+    for( const auto &veh : sm.vehicles ) {
+        bytes += sizeof( vehicle ) + veh->parts.size() * sizeof( vehicle_part );
+    }
+    bytes += sm.spawns.size() * sizeof( spawn_point );
+    bytes += sm.cosmetics.size() * sizeof( submap::cosmetic_t );
+    bytes += sm.partial_constructions.size() * sizeof( partial_con );
+    return bytes;
+}
+
 mapbuffer MAPBUFFER;
 
 mapbuffer::mapbuffer() = default;
@@ -49,6 +112,11 @@ void mapbuffer::reset()
         delete elem.second;
     }
     submaps.clear();
+    legacy_quad_paths.clear();
+    evicted_quads.clear();
+    prefetched.clear();
+    quad_usages.clear();
+    loaded_quads = false;
 }
 
 bool mapbuffer::add_submap( const tripoint &p, submap *sm )
@@ -58,6 +126,8 @@ bool mapbuffer::add_submap( const tripoint &p, submap *sm )
     }
 
     submaps[p] = sm;
+    touch( p );
+    loaded_quads = true;
 
     return true;
 }
@@ -90,6 +160,14 @@ void mapbuffer::remove_submap( tripoint addr )
     }
     delete m_target->second;
     submaps.erase( m_target );
+
+    const tripoint om_addr = sm_to_omt_copy( addr );
+    const auto quad = quad_submaps( om_addr );
+    if( std::none_of( quad.begin(), quad.end(), [this]( const tripoint & p ) {
+    return submaps.count( p ) != 0;
+    } ) ) {
+        quad_usages.erase( om_addr );
+    }
 }
 
 submap *mapbuffer::lookup_submap( int x, int y, int z )
@@ -111,65 +189,348 @@ submap *mapbuffer::lookup_submap( const tripoint &p )
         return nullptr;
     }
 
+    touch( p );
     return iter->second;
 }
 
+void mapbuffer::touch( const tripoint &p )
+{
+    quad_usage &usage = quad_usages[sm_to_omt_copy( p )];
+    usage.last_used = ++use_counter;
+    usage.dirty = true;
+    usage.bytes = 0;
+}
+
+void mapbuffer::check_failed_writes()
+{
+    const int failed_writes = background_save::failures();
+    if( failed_writes == failed_writes_seen ) {
+        return;
+    }
+    failed_writes_seen = failed_writes;
+    for( auto &elem : quad_usages ) {
+        elem.second.dirty = true;
+    }
+    for( auto &elem : evicted_quads ) {
+        elem.second.written = false;
+    }
+}
+
+size_t mapbuffer::quad_memory_usage( const tripoint &om_addr )
+{
+    quad_usage &usage = quad_usages[om_addr];
+    if( usage.bytes == 0 ) {
+        for( const tripoint &p : quad_submaps( om_addr ) ) {
+            const auto iter = submaps.find( p );
+            if( iter != submaps.end() && iter->second != nullptr ) {
+                usage.bytes += estimate_memory( *iter->second );
+            }
+        }
+    }
+    return usage.bytes;
+}
+
+void mapbuffer::enforce_memory_budget()
+{
+    const int budget_mib = get_option<int>( "MAP_MEMORY_BUDGET" );
+    // Memory only grows much by loading more quads.
+    if( budget_mib <= 0 || !loaded_quads ) {
+        return;
+    }
+    loaded_quads = false;
+    const size_t budget = static_cast<size_t>( budget_mib ) * 1024 * 1024;
+
+    size_t total = 0;
+    for( const auto &elem : evicted_quads ) {
+        total += elem.second.data.size();
+    }
+    std::vector<std::pair<uint64_t, tripoint>> candidates;
+    for( auto &elem : quad_usages ) {
+        if( quad_in_map( elem.first ) ) {
+            // The contents of the map change all the time.
+            elem.second.bytes = 0;
+        } else {
+            candidates.emplace_back( elem.second.last_used, elem.first );
+        }
+        total += quad_memory_usage( elem.first );
+    }
+    if( total <= budget ) {
+        return;
+    }
+
+    // Least recently used first.
+    std::sort( candidates.begin(), candidates.end() );
+    const bool binary = get_option<std::string>( "MAP_SAVE_FORMAT" ) == "binary";
+    std::list<tripoint> submaps_to_delete;
+    for( const auto &candidate : candidates ) {
+        if( total <= budget ) {
+            break;
+        }
+        const tripoint &om_addr = candidate.second;
+        const quad_usage &usage = quad_usages[om_addr];
+        total -= usage.bytes;
+        if( !usage.dirty ) {
+            // It is only clean once the write of the last save succeeded.
+            background_save::wait_for( find_region_path( om_addr ) );
+            check_failed_writes();
+        }
+        if( usage.dirty ) {
+            // Writing it here would change the world files without saving the game.
+            std::string quad_data;
+            if( save_quad( om_addr, quad_data, submaps_to_delete, true, binary ) ) {
+                total += quad_data.size();
+                evicted_quads[om_addr].data = std::move( quad_data );
+            }
+            continue;
+        }
+        // Unchanged since it has been saved, it can simply be loaded again.
+        for( const tripoint &p : quad_submaps( om_addr ) ) {
+            if( submaps.count( p ) != 0 ) {
+                submaps_to_delete.push_back( p );
+            }
+        }
+    }
+
+    for( const tripoint &p : submaps_to_delete ) {
+        remove_submap( p );
+    }
+}
+
+std::vector<mapbuffer::quad_memory> mapbuffer::memory_usage()
+{
+    std::vector<std::pair<std::pair<bool, uint64_t>, tripoint>> order;
+    for( auto &elem : quad_usages ) {
+        const bool in_map = quad_in_map( elem.first );
+        if( in_map ) {
+            elem.second.bytes = 0;
+        }
+        order.emplace_back( std::make_pair( in_map, elem.second.last_used ), elem.first );
+    }
+    std::sort( order.begin(), order.end() );
+
+    std::vector<quad_memory> result;
+    for( const auto &elem : order ) {
+        const tripoint &om_addr = elem.second;
+        result.push_back( { om_addr, quad_memory_usage( om_addr ), quad_usages[om_addr].dirty } );
+    }
+    return result;
+}
+
+void mapbuffer::prefetch( const std::set<tripoint> &om_addrs )
+{
+    for( auto iter = prefetched.begin(); iter != prefetched.end(); ) {
+        if( om_addrs.count( iter->first ) == 0 ) {
+            // A job that is still reading keeps its own reference to the data.
+            iter = prefetched.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
+
+    for( const tripoint &om_addr : om_addrs ) {
+        if( prefetched.count( om_addr ) != 0 || submaps.count( omt_to_sm_copy( om_addr ) ) != 0 ||
+            evicted_quads.count( om_addr ) != 0 ) {
+            continue;
+        }
+        const auto quad = std::make_shared<prefetched_quad>();
+        prefetched.emplace( om_addr, quad );
+        // Queued behind the writes of the same file, so this never sees a half written region.
+        const std::string region_path = find_region_path( om_addr );
+        const int index = find_region_index( om_addr );
+        background_save::enqueue( region_path, [region_path, index, quad]() {
+            try {
+                quad->found = region_file( region_path ).read( index, quad->data );
+                quad->read = true;
+            } catch( const std::exception & ) {
+                // Reading it again when it is needed reports the error.
+            }
+        } );
+    }
+}
+
+bool mapbuffer::take_prefetched( const tripoint &om_addr, bool &found, std::string &data )
+{
+    const auto iter = prefetched.find( om_addr );
+    if( iter == prefetched.end() ) {
+        return false;
+    }
+    const std::shared_ptr<prefetched_quad> quad = iter->second;
+    prefetched.erase( iter );
+    // Usually done long ago, otherwise this waits for the read that would be done here anyway.
+    background_save::wait_for( find_region_path( om_addr ) );
+    if( !quad->read ) {
+        return false;
+    }
+    found = quad->found;
+    data = std::move( quad->data );
+    return true;
+}
+
 void mapbuffer::save( bool delete_after_save )
 {
+    // The writes of the last save are done, see game::save.
+    check_failed_writes();
+    for( auto iter = evicted_quads.begin(); iter != evicted_quads.end(); ) {
+        if( iter->second.written ) {
+            iter = evicted_quads.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
     assure_dir_exist( g->get_world_base_save_path() + "/maps" );
 
     int num_saved_submaps = 0;
     int num_total_submaps = submaps.size();
 
-    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
-    const bool map_has_zlevels = g != nullptr && g->m.has_zlevels();
+    const bool binary = get_option<std::string>( "MAP_SAVE_FORMAT" ) == "binary";
+    // With a memory budget the quads outside of the map are unloaded by enforce_memory_budget.
+    const bool keep_unused = get_option<int>( "MAP_MEMORY_BUDGET" ) > 0;
 
-    // A set of already-saved submaps, in global overmap coordinates.
-    std::set<tripoint> saved_submaps;
-    std::list<tripoint> submaps_to_delete;
-    int next_report = 0;
+    // Whatever the coordinates of the current submap are,
+    // we're saving a 2x2 quad of submaps at a time.
+    // Submaps are generated in quads, so we know if we have one member of a quad,
+    // we have the rest of it, if that assumption is broken we have REAL problems.
+    // The quads are grouped by their segment, so each region file is written once.
+    std::map<tripoint, std::set<tripoint>> quads_by_segment;
     for( auto &elem : submaps ) {
-        if( num_total_submaps > 100 && num_saved_submaps >= next_report ) {
-            popup_nowait( _( "Please wait as the map saves [%d/%d]" ),
-                          num_saved_submaps, num_total_submaps );
-            next_report += std::max( 100, num_total_submaps / 20 );
-        }
-
-        // Whatever the coordinates of the current submap are,
-        // we're saving a 2x2 quad of submaps at a time.
-        // Submaps are generated in quads, so we know if we have one member of a quad,
-        // we have the rest of it, if that assumption is broken we have REAL problems.
         const tripoint om_addr = sm_to_omt_copy( elem.first );
-        if( saved_submaps.count( om_addr ) != 0 ) {
-            // Already handled this one.
-            continue;
-        }
-        saved_submaps.insert( om_addr );
+        quads_by_segment[omt_to_seg_copy( om_addr )].insert( om_addr );
+    }
+    for( const auto &elem : evicted_quads ) {
+        quads_by_segment[omt_to_seg_copy( elem.first )].insert( elem.first );
+    }
 
-        // A segment is a chunk of 32x32 submap quads.
-        // We're breaking them into subdirectories so there aren't too many files per directory.
-        // Might want to make a set for this one too so it's only checked once per save().
-        const std::string dirname = find_dirname( om_addr );
-        const std::string quad_path = find_quad_path( dirname, om_addr );
+    std::list<tripoint> submaps_to_delete;
+    save_report report;
+    int next_report = 0;
+    for( const auto &segment : quads_by_segment ) {
+        std::map<int, std::string> region_data;
+        for( const tripoint &om_addr : segment.second ) {
+            if( num_total_submaps > 100 && num_saved_submaps >= next_report ) {
+                popup_nowait( _( "Please wait as the map saves [%d/%d]" ),
+                              num_saved_submaps, num_total_submaps );
+                next_report += std::max( 100, num_total_submaps / 20 );
+            }
 
-        // delete_on_save deletes everything, otherwise delete submaps
-        // outside the current map.
-        const bool zlev_del = !map_has_zlevels && om_addr.z != g->get_levz();
-        save_quad( dirname, quad_path, om_addr, submaps_to_delete,
-                   delete_after_save || zlev_del ||
-                   om_addr.x < map_origin.x || om_addr.y < map_origin.y ||
-                   om_addr.x > map_origin.x + HALF_MAPSIZE ||
-                   om_addr.y > map_origin.y + HALF_MAPSIZE );
-        num_saved_submaps += 4;
+            const auto evicted = evicted_quads.find( om_addr );
+            if( evicted != evicted_quads.end() ) {
+                // Copied, it stays in memory until the write is known to have succeeded.
+                region_data[find_region_index( om_addr )] = evicted->second.data;
+                evicted->second.written = true;
+                report.quads_written++;
+                report.bytes_written += evicted->second.data.size();
+                continue;
+            }
+            // delete_on_save deletes everything, otherwise delete submaps
+            // outside the current map, unless the memory budget takes care of them.
+            const bool in_map = quad_in_map( om_addr );
+            const bool delete_quad = delete_after_save || ( !in_map && !keep_unused );
+            // Submaps outside of the map are only changed after a lookup, which marks them dirty.
+            if( !in_map && !quad_usages[om_addr].dirty ) {
+                if( delete_quad ) {
+                    for( const tripoint &p : quad_submaps( om_addr ) ) {
+                        if( submaps.count( p ) > 0 ) {
+                            submaps_to_delete.push_back( p );
+                        }
+                    }
+                }
+                report.quads_unchanged++;
+                num_saved_submaps += 4;
+                continue;
+            }
+            std::string quad_data;
+            if( save_quad( om_addr, quad_data, submaps_to_delete, delete_quad, binary ) ) {
+                report.quads_written++;
+                report.bytes_written += quad_data.size();
+                region_data[find_region_index( om_addr )] = std::move( quad_data );
+            }
+            // The quads in the map only stay unchanged until the next turn.
+            if( !in_map ) {
+                quad_usages[om_addr].dirty = false;
+            }
+            num_saved_submaps += 4;
+        }
+        if( !region_data.empty() ) {
+            write_region( segment.second, std::move( region_data ), background_save::collecting() );
+        }
     }
     for( auto &elem : submaps_to_delete ) {
         remove_submap( elem );
     }
+    dbg( D_INFO ) << "saved " << report.quads_written << " quads (" << report.bytes_written <<
+                  " bytes), " << report.quads_unchanged << " unchanged quads skipped";
+    last_save_report = report;
+}
+
+void mapbuffer::write_region( const std::set<tripoint> &quads,
+                              std::map<int, std::string> region_data, const bool in_background )
+{
+    // The quads that were read from their own files live in the region file now.
+    std::vector<std::string> legacy_paths;
+    for( const tripoint &quad : quads ) {
+        const auto legacy = legacy_quad_paths.find( quad );
+        if( legacy != legacy_quad_paths.end() &&
+            region_data.count( find_region_index( quad ) ) != 0 ) {
+            legacy_paths.push_back( legacy->second );
+            legacy_quad_paths.erase( legacy );
+        }
+    }
+    const std::string region_path = find_region_path( *quads.begin() );
+    auto write = [region_path, region_data = std::move( region_data ),
+                  legacy_paths = std::move( legacy_paths )]() {
+        region_file( region_path ).write( region_data );
+        for( const std::string &path : legacy_paths ) {
+            remove_file( path );
+        }
+    };
+    if( in_background ) {
+        background_save::enqueue( region_path, std::move( write ) );
+    } else {
+        background_save::wait_for( region_path );
+        write();
+    }
 }
 
-void mapbuffer::save_quad( const std::string &dirname, const std::string &filename,
-                           const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                           bool delete_after_save )
+int mapbuffer::convert_saved_maps( const bool binary )
+{
+    background_save::wait();
+    int converted = 0;
+    const std::string maps_dir = g->get_world_base_save_path() + "/maps";
+    for( const std::string &path : get_files_from_path( ".region", maps_dir, false, true ) ) {
+        region_file region( path );
+        std::map<int, std::string> region_data;
+        for( int index = 0; index < region_file::entries; index++ ) {
+            std::string data;
+            if( !region.read( index, data ) || is_binary_quad( data ) == binary ) {
+                continue;
+            }
+            // The quad is loaded into a buffer of its own, the submaps in use stay untouched.
+            mapbuffer quad;
+            try {
+                quad.deserialize_quad( data );
+            } catch( const std::exception &err ) {
+                throw std::runtime_error( path + ": " + err.what() );
+            }
+            if( quad.submaps.empty() ) {
+                continue;
+            }
+            std::list<tripoint> unused;
+            const tripoint om_addr = sm_to_omt_copy( quad.submaps.begin()->first );
+            if( quad.save_quad( om_addr, data, unused, false, binary ) ) {
+                region_data[index] = std::move( data );
+                converted++;
+            }
+        }
+        if( !region_data.empty() ) {
+            region.write( region_data );
+        }
+    }
+    return converted;
+}
+
+bool mapbuffer::save_quad( const tripoint &om_addr, std::string &data,
+                           std::list<tripoint> &submaps_to_delete, bool delete_after_save,
+                           bool binary )
 {
     std::vector<point> offsets;
     std::vector<tripoint> submap_addrs;
@@ -200,47 +561,76 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
             }
         }
 
-        return;
+        return false;
     }
 
-    // Don't create the directory if it would be empty
-    assure_dir_exist( dirname );
-    write_to_file( filename, [&]( std::ostream & fout ) {
-        JsonOut jsout( fout );
-        jsout.start_array();
+    if( binary ) {
+        std::vector<const submap *> quad_submaps;
+        std::vector<tripoint> quad_addrs;
         for( auto &submap_addr : submap_addrs ) {
-            if( submaps.count( submap_addr ) == 0 ) {
+            const auto iter = submaps.find( submap_addr );
+            if( iter == submaps.end() || iter->second == nullptr ) {
                 continue;
             }
+            quad_submaps.push_back( iter->second );
+            quad_addrs.push_back( submap_addr );
+            if( delete_after_save ) {
+                submaps_to_delete.push_back( submap_addr );
+            }
+        }
 
-            submap *sm = submaps[submap_addr];
+        binary_out out;
+        out.write_varint( binary_quad_version );
+        out.write_int( savegame_version );
+        out.write_varint( quad_submaps.size() );
+        for( size_t i = 0; i < quad_submaps.size(); i++ ) {
+            out.write_int( quad_addrs[i].x );
+            out.write_int( quad_addrs[i].y );
+            out.write_int( quad_addrs[i].z );
+            quad_submaps[i]->store_binary( out );
+        }
+        data = binary_quad_magic;
+        out.finish( data );
+        return true;
+    }
 
-            if( sm == nullptr ) {
-                continue;
-            }
+    std::ostringstream fout;
+    JsonOut jsout( fout );
+    jsout.start_array();
+    for( auto &submap_addr : submap_addrs ) {
+        if( submaps.count( submap_addr ) == 0 ) {
+            continue;
+        }
 
-            jsout.start_object();
+        submap *sm = submaps[submap_addr];
 
-            jsout.member( "version", savegame_version );
-            jsout.member( "coordinates" );
+        if( sm == nullptr ) {
+            continue;
+        }
 
-            jsout.start_array();
-            jsout.write( submap_addr.x );
-            jsout.write( submap_addr.y );
-            jsout.write( submap_addr.z );
-            jsout.end_array();
+        jsout.start_object();
 
-            sm->store( jsout );
+        jsout.member( "version", savegame_version );
+        jsout.member( "coordinates" );
 
-            jsout.end_object();
+        jsout.start_array();
+        jsout.write( submap_addr.x );
+        jsout.write( submap_addr.y );
+        jsout.write( submap_addr.z );
+        jsout.end_array();
 
-            if( delete_after_save ) {
-                submaps_to_delete.push_back( submap_addr );
-            }
+        sm->store( jsout );
+
+        jsout.end_object();
+
+        if( delete_after_save ) {
+            submaps_to_delete.push_back( submap_addr );
         }
+    }
 
-        jsout.end_array();
-    } );
+    jsout.end_array();
+    data = fout.str();
+    return true;
 }
 
 // We're reading in way too many entities here to mess around with creating sub-objects and
@@ -249,6 +639,41 @@ submap *mapbuffer::unserialize_submaps( const tripoint &p )
 {
     // Map the tripoint to the submap quad that stores it.
     const tripoint om_addr = sm_to_omt_copy( p );
+    const auto evicted = evicted_quads.find( om_addr );
+    if( evicted != evicted_quads.end() ) {
+        // Newer than the saved data. Once loaded the quad is dirty until it is saved again.
+        deserialize_quad( evicted->second.data );
+        evicted_quads.erase( evicted );
+        if( submaps.count( p ) == 0 ) {
+            debugmsg( "unloaded quad %d,%d,%d did not contain the expected submap %d,%d,%d",
+                      om_addr.x, om_addr.y, om_addr.z, p.x, p.y, p.z );
+            return nullptr;
+        }
+        return submaps[ p ];
+    }
+    const std::string region_path = find_region_path( om_addr );
+    std::string region_data;
+    bool in_region = false;
+    if( !take_prefetched( om_addr, in_region, region_data ) ) {
+        background_save::wait_for( region_path );
+        in_region = region_file( region_path ).read( find_region_index( om_addr ), region_data );
+    }
+    if( in_region ) {
+        try {
+            deserialize_quad( region_data );
+        } catch( const std::exception &err ) {
+            throw std::runtime_error( region_path + ": " + err.what() );
+        }
+        if( submaps.count( p ) == 0 ) {
+            debugmsg( "region file %s did not contain the expected submap %d,%d,%d",
+                      region_path, p.x, p.y, p.z );
+            return nullptr;
+        }
+        return submaps[ p ];
+    }
+
+    // Quads that have not been saved since the region files were introduced have their own file.
+    // They get moved into the region file the next time they are saved.
     const std::string dirname = find_dirname( om_addr );
     std::string quad_path = find_quad_path( dirname, om_addr );
 
@@ -269,6 +694,7 @@ submap *mapbuffer::unserialize_submaps( const tripoint &p )
         // If it doesn't exist, trigger generating it.
         return nullptr;
     }
+    legacy_quad_paths[om_addr] = quad_path;
     if( submaps.count( p ) == 0 ) {
         debugmsg( "file %s did not contain the expected submap %d,%d,%d",
                   quad_path, p.x, p.y, p.z );
@@ -307,3 +733,38 @@ void mapbuffer::deserialize( JsonIn &jsin )
         }
     }
 }
+
+void mapbuffer::deserialize_binary( const std::string &data )
+{
+    // The magic is followed by the id table of the binary_out the quad was written with.
+    binary_in in( data, binary_quad_magic.size() );
+    const uint64_t format = in.read_varint();
+    if( format != binary_quad_version ) {
+        throw std::runtime_error( string_format( "unknown binary map format %d", format ) );
+    }
+    const int version = in.read_int();
+    const uint64_t count = in.read_varint();
+    for( uint64_t i = 0; i < count; i++ ) {
+        const int locx = in.read_int();
+        const int locy = in.read_int();
+        const int locz = in.read_int();
+        const tripoint submap_coordinates( locx, locy, locz );
+        std::unique_ptr<submap> sm = std::make_unique<submap>();
+        sm->load_binary( in, version );
+
+        if( !add_submap( submap_coordinates, sm ) ) {
+            debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
+                      submap_coordinates.z );
+        }
+    }
+}
+
+void mapbuffer::deserialize_quad( const std::string &data )
+{
+    if( is_binary_quad( data ) ) {
+        deserialize_binary( data );
+        return;
+    }
+    JsonIn jsin( data );
+    deserialize( jsin );
+}
@@ -2,10 +2,14 @@
 #ifndef MAPBUFFER_H
 #define MAPBUFFER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "point.h"
 
@@ -22,11 +26,30 @@ class mapbuffer
         ~mapbuffer();
 
         /** Store all submaps in this instance into savefiles.
+         * Quads outside of the map that have not been used since they were last saved are
+         * skipped, their saved data is still up to date.
          * @param delete_after_save If true, the saved submaps are removed
          * from the mapbuffer (and deleted).
          **/
         void save( bool delete_after_save = false );
 
+        struct save_report {
+            int quads_written = 0;
+            int quads_unchanged = 0;
+            size_t bytes_written = 0;
+        };
+        /** What the last call of @ref save did. */
+        const save_report &last_save() const {
+            return last_save_report;
+        }
+
+        /**
+         * Rewrites all saved quads of the world that are not in the binary (if @p binary is
+         * true) or JSON format in that format. Nothing gets lost in either direction.
+         * @return The number of converted quads.
+         */
+        int convert_saved_maps( bool binary );
+
         /** Delete all buffered submaps. **/
         void reset();
 
@@ -57,6 +80,35 @@ class mapbuffer
         submap *lookup_submap( int x, int y, int z );
         submap *lookup_submap( const tripoint &p );
 
+        /**
+         * Starts reading the saved quads @p om_addrs (overmap terrain coordinates) in the
+         * background, so @ref lookup_submap does not have to wait for the disk later.
+         * Quads that are already loaded are skipped. Quads read ahead by earlier calls that
+         * are not in @p om_addrs anymore are dropped.
+         */
+        void prefetch( const std::set<tripoint> &om_addrs );
+
+        /**
+         * If the loaded submaps use more memory than the "MAP_MEMORY_BUDGET" option allows,
+         * unloads the quads outside of the map around the avatar that have been unused the
+         * longest. Quads that may have changed since they were saved are kept in memory in
+         * their serialized form, the next @ref save writes them. The world files are only
+         * written by saving the game.
+         * Must not be called while submaps outside of the map are in use.
+         */
+        void enforce_memory_budget();
+
+        struct quad_memory {
+            /** Overmap terrain coordinates of the quad. */
+            tripoint om_addr;
+            /** Estimated memory of its submaps. */
+            size_t bytes;
+            /** Whether the quad may have changed since it was saved. */
+            bool dirty;
+        };
+        /** Memory used by all loaded quads, in the order they would be unloaded. */
+        std::vector<quad_memory> memory_usage();
+
     private:
         using submap_map_t = std::map<tripoint, submap *>;
 
@@ -74,10 +126,79 @@ class mapbuffer
         void remove_submap( tripoint addr );
         submap *unserialize_submaps( const tripoint &p );
         void deserialize( JsonIn &jsin );
-        void save_quad( const std::string &dirname, const std::string &filename,
-                        const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
-                        bool delete_after_save );
+        void deserialize_binary( const std::string &data );
+        /** Loads the submaps of a quad saved in either format. */
+        void deserialize_quad( const std::string &data );
+        /**
+         * Serializes the submaps of the quad @p om_addr into @p data, in the binary format
+         * if @p binary is true, as JSON otherwise.
+         * @return false if there is nothing worth saving.
+         */
+        bool save_quad( const tripoint &om_addr, std::string &data,
+                        std::list<tripoint> &submaps_to_delete, bool delete_after_save, bool binary );
+        /**
+         * Takes the data of quad @p om_addr out of the ones read by @ref prefetch.
+         * @return false if the quad was not read ahead or reading it failed.
+         */
+        bool take_prefetched( const tripoint &om_addr, bool &found, std::string &data );
+        /** Marks the quad of submap @p p as used and possibly changed. */
+        void touch( const tripoint &p );
+        /**
+         * Marks all quads dirty if a background write failed since the last call, any of
+         * them may be missing from the files. The unloaded quads are written again, too.
+         */
+        void check_failed_writes();
+        /** Estimated memory of the quad @p om_addr, cached while it is outside of the map. */
+        size_t quad_memory_usage( const tripoint &om_addr );
+        /**
+         * Writes @p region_data (see @ref save_quad) of the @p quads of one region file,
+         * on the background thread if @p in_background is true.
+         */
+        void write_region( const std::set<tripoint> &quads, std::map<int, std::string> region_data,
+                           bool in_background );
         submap_map_t submaps;
+        /** Quads that were read from their own file instead of a region file, and that file. */
+        std::map<tripoint, std::string> legacy_quad_paths;
+
+        /** A region file entry read on the background thread. */
+        struct prefetched_quad {
+            /** Whether reading is done and succeeded. */
+            bool read = false;
+            /** Whether the region file has the quad. */
+            bool found = false;
+            std::string data;
+        };
+        struct quad_usage {
+            /** Value of @ref use_counter when the quad was used the last time. */
+            uint64_t last_used = 0;
+            /** Whether the quad may have changed since it was saved the last time. */
+            bool dirty = true;
+            /** Estimated memory, 0 if it needs to be computed again. */
+            size_t bytes = 0;
+        };
+        /** A dirty quad unloaded by @ref enforce_memory_budget. */
+        struct evicted_quad {
+            /** See @ref save_quad. */
+            std::string data;
+            /**
+             * Whether a save has queued writing it. It is kept until the next save knows
+             * that the write succeeded.
+             */
+            bool written = false;
+        };
+        /** Evicted quads that are newer than their saved data, by overmap terrain coordinates. */
+        std::map<tripoint, evicted_quad> evicted_quads;
+        /** Usage of the loaded quads, by overmap terrain coordinates. */
+        std::map<tripoint, quad_usage> quad_usages;
+        save_report last_save_report;
+        uint64_t use_counter = 0;
+        /** Whether quads have been loaded since the last @ref enforce_memory_budget. */
+        bool loaded_quads = false;
+        /** Value of background_save::failures at the last @ref check_failed_writes. */
+        int failed_writes_seen = 0;
+
+        /** The data is filled in on the background thread, it is only used after waiting for that. */
+        std::map<tripoint, std::shared_ptr<prefetched_quad>> prefetched;
 };
 
 extern mapbuffer MAPBUFFER;
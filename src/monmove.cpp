@@ -8,6 +8,7 @@
 #include <memory>
 #include <ostream>
 #include <list>
+#include <set>
 #include <cfloat>
 
 #include "avatar.h"
@@ -36,6 +37,7 @@
 #include "game_constants.h"
 #include "mattack_common.h"
 #include "pathfinding.h"
+#include "profiler.h"
 #include "player.h"
 #include "int_id.h"
 #include "string_id.h"
@@ -294,6 +296,7 @@ float monster::rate_target( Creature &c, float best, bool smart ) const
 
 void monster::plan()
 {
+    CATA_PROFILE_ZONE( "monster::plan" );
     const auto &factions = g->critter_tracker->factions();
 
     // Bots are more intelligent than most living stuff
@@ -341,10 +344,10 @@ void monster::plan()
             }
         }
         if( angers_cub_threatened > 0 ) {
-            for( monster &tmp : g->all_monsters() ) {
-                if( type->baby_monster == tmp.type->id ) {
+            for( monster *const tmp : g->critter_tracker->creatures_in_radius( g->u.pos(), 3 ) ) {
+                if( type->baby_monster == tmp->type->id ) {
                     // baby nearby; is the player too close?
-                    dist = tmp.rate_target( g->u, dist, smart_planning );
+                    dist = tmp->rate_target( g->u, dist, smart_planning );
                     if( dist <= 3 ) {
                         //proximity to baby; monster gets furious and less likely to flee
                         anger += angers_cub_threatened;
@@ -354,11 +357,13 @@ void monster::plan()
             }
         }
     } else if( friendly != 0 && !docile ) {
-        for( monster &tmp : g->all_monsters() ) {
-            if( tmp.friendly == 0 ) {
-                float rating = rate_target( tmp, dist, smart_planning );
+        // Monsters further away than our sight range can't be seen (see Creature::sees).
+        const int sight_radius = std::max( max_sight_range, 1 );
+        for( monster *const tmp : g->critter_tracker->creatures_in_radius( pos(), sight_radius ) ) {
+            if( tmp->friendly == 0 ) {
+                float rating = rate_target( *tmp, dist, smart_planning );
                 if( rating < dist ) {
-                    target = &tmp;
+                    target = tmp;
                     dist = rating;
                 }
             }
@@ -781,7 +786,13 @@ void monster::move()
         if( pf_settings.max_dist >= rl_dist( pos(), goal ) &&
             ( path.empty() || rl_dist( pos(), path.front() ) >= 2 || path.back() != goal ) ) {
             // We need a new path
-            path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            const std::set<tripoint> path_avoid = get_path_avoid();
+            if( path_avoid.empty() && g->critter_at( goal ) != nullptr ) {
+                // Probably not the only one going for that creature, share the search.
+                path = g->m.shared_route( pos(), goal, pf_settings );
+            } else {
+                path = g->m.route( pos(), goal, pf_settings, path_avoid );
+            }
         }
 
         // Try to respect old paths, even if we can't pathfind at the moment
@@ -1092,11 +1103,6 @@ void monster::footsteps( const tripoint &p )
 
 tripoint monster::scent_move()
 {
-    // TODO: Remove when scentmap is 3D
-    if( abs( posz() - g->get_levz() ) > SCENT_MAP_Z_REACH ) {
-        return { -1, -1, INT_MIN };
-    }
-
     const std::set<scenttype_id> &tracked_scents = type->scents_tracked;
     const std::set<scenttype_id> &ignored_scents = type->scents_ignored;
 
@@ -1244,6 +1244,11 @@ void options_manager::add_options_general()
 
     get_option( "AUTOSAVE_MINUTES" ).setPrerequisite( "AUTOSAVE" );
 
+    add( "MAP_MEMORY_BUDGET", "general", translate_marker( "Map memory budget" ),
+         translate_marker( "Memory in MiB the loaded map may use before the submaps that have been unused the longest are unloaded.  Changed submaps are kept in a compact form until the game is saved.  The surroundings of the player are always kept.  0 keeps everything until the game is saved." ),
+         0, 65536, 512
+       );
+
     add_empty_line();
 
     add( "AUTO_NOTES", "general", translate_marker( "Auto notes" ),
@@ -2143,6 +2148,14 @@ void options_manager::add_options_world_default()
     { { "any", translate_marker( "Any" ) }, { "multi_pool", translate_marker( "Multi-pool only" ) }, { "no_freeform", translate_marker( "No freeform" ) } },
     "any"
        );
+
+    add_empty_line();
+
+    add( "MAP_SAVE_FORMAT", "world_default", translate_marker( "Map save format" ),
+         translate_marker( "Format of the saved map.  Binary is smaller and faster to save and load, JSON can be read and edited by hand.  Maps in either format can always be loaded, they are converted when saved the next time." ),
+    { { "binary", translate_marker( "Binary" ) }, { "json", translate_marker( "JSON" ) } },
+    "binary"
+       );
 }
 
 void options_manager::add_options_android()
@@ -12,6 +12,7 @@
 #include <exception>
 #include <unordered_set>
 #include <set>
+#include <sstream>
 
 #include "catacharset.h"
 #include "cata_utility.h"
@@ -4365,15 +4366,32 @@ void overmap::open( overmap_special_batch &enabled_specials )
 }
 
 // Note: this may throw io errors from std::ofstream
-void overmap::save() const
+// Writes @p data to @p path unless it is the same as the last time, as given by @p saved_hash.
+// overmapbuffer::save forgets the hashes when a background write failed.
+static size_t write_if_changed( const std::string &path, const std::string &data,
+                                size_t &saved_hash )
 {
-    write_to_file( overmapbuffer::player_filename( loc ), [&]( std::ostream & stream ) {
-        serialize_view( stream );
+    const size_t hash = std::hash<std::string>()( data );
+    if( hash == saved_hash ) {
+        return 0;
+    }
+    write_to_file( path, [&data]( std::ostream & stream ) {
+        stream.write( data.data(), data.size() );
     } );
+    saved_hash = hash;
+    return data.size();
+}
 
-    write_to_file( overmapbuffer::terrain_filename( loc ), [&]( std::ostream & stream ) {
-        serialize( stream );
-    } );
+size_t overmap::save()
+{
+    // Seen and explored tiles, notes and the monster groups change all the time, but only
+    // in some of the loaded overmaps. Serializing is much cheaper than writing the files.
+    std::ostringstream view;
+    serialize_view( view );
+    std::ostringstream terrain;
+    serialize( terrain );
+    return write_if_changed( overmapbuffer::player_filename( loc ), view.str(), saved_view_hash ) +
+           write_if_changed( overmapbuffer::terrain_filename( loc ), terrain.str(), saved_terrain_hash );
 }
 
 void overmap::add_mon_group( const mongroup &group )
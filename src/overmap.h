@@ -211,7 +211,11 @@ class overmap
             return loc;
         }
 
-        void save() const;
+        /**
+         * Writes the files of this overmap that changed since they were last written.
+         * @return The number of bytes written.
+         */
+        size_t save();
 
         /**
          * @return The (local) overmap terrain coordinates of a randomly
@@ -342,6 +346,9 @@ class overmap
 
         bool nullbool = false;
         point loc = point_zero;
+        /** Hashes of the files as they were last written, 0 before the first save. */
+        size_t saved_view_hash = 0;
+        size_t saved_terrain_hash = 0;
 
         std::array<map_layer, OVERMAP_LAYERS> layer;
         std::unordered_map<tripoint, scent_trace> scents;
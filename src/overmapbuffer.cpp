@@ -9,6 +9,7 @@
 #include <map>
 
 #include "avatar.h"
+#include "background_save.h"
 #include "basecamp.h"
 #include "cata_utility.h"
 #include "coordinate_conversions.h"
@@ -188,10 +189,22 @@ void overmapbuffer::fix_npcs( overmap &new_overmap )
 
 void overmapbuffer::save()
 {
+    // The overmaps only remember what they wrote, a failed write may have left any file behind.
+    const int failed_writes = background_save::failures();
+    if( failed_writes != failed_writes_seen ) {
+        failed_writes_seen = failed_writes;
+        for( auto &omp : overmaps ) {
+            omp.second->saved_view_hash = 0;
+            omp.second->saved_terrain_hash = 0;
+        }
+    }
+    size_t bytes = 0;
     for( auto &omp : overmaps ) {
         // Note: this may throw io errors from std::ofstream
-        omp.second->save();
+        bytes += omp.second->save();
     }
+    DebugLog( D_INFO, D_GAME ) << "saved " << overmaps.size() << " overmaps, " << bytes <<
+                               " bytes written";
 }
 
 void overmapbuffer::clear()
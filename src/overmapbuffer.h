@@ -481,6 +481,8 @@ class overmapbuffer
         mutable std::set<point> known_non_existing;
         // Cached result of previous call to overmapbuffer::get_existing
         overmap mutable *last_requested_overmap;
+        /** Value of background_save::failures at the last @ref save. */
+        int failed_writes_seen = 0;
 
         /**
          * Get a list of notes in the (loaded) overmaps.
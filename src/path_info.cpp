@@ -197,6 +197,10 @@ std::string PATH_INFO::custom_colors()
 {
     return config_dir_value + "custom_colors.json";
 }
+std::string PATH_INFO::datacachedir()
+{
+    return user_dir_value + "cache/";
+}
 std::string PATH_INFO::datadir()
 {
     return datadir_value;
@@ -20,6 +20,7 @@ std::string color_templates();
 std::string config_dir();
 std::string custom_colors();
 std::string datadir();
+std::string datacachedir();
 std::string debug();
 std::string defaultsounddir();
 std::string defaulttilejson();
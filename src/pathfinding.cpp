@@ -5,10 +5,14 @@
 #include <queue>
 #include <set>
 #include <array>
+#include <bitset>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "calendar.h"
 #include "cata_utility.h"
 #include "coordinates.h"
 #include "debug.h"
@@ -30,6 +34,9 @@ enum astar_state {
     ASL_CLOSED
 };
 
+// Tiles with any of these need a closer look, everything else is flat ground.
+static constexpr pf_special non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP | PF_SHARP;
+
 // Turns two indexed to a 2D array into an index to equivalent 1D array
 constexpr int flat_index( const int x, const int y )
 {
@@ -177,6 +184,224 @@ bool is_disjoint( const Set1 &set1, const Set2 &set2 )
     return true;
 }
 
+using pf_special_grid = pf_special[MAPSIZE_X][MAPSIZE_Y];
+
+// Index of the submap containing the tile, as used by pathfinding_portals::submaps.
+static int submap_index( const point &p )
+{
+    return p.x / SEEX * MAPSIZE + p.y / SEEY;
+}
+
+// Costs of walking from `from` to every tile of its submap without leaving it, in the
+// same units as the A* in map::route, -1 for unreachable tiles.
+static std::array<int, SEEX * SEEY> submap_distances( const pf_special_grid &special,
+        const point &from )
+{
+    const point origin( from.x / SEEX * SEEX, from.y / SEEY * SEEY );
+    std::array<int, SEEX * SEEY> dist;
+    dist.fill( -1 );
+    std::priority_queue<std::pair<int, point>, std::vector<std::pair<int, point>>, pair_greater_cmp_first>
+    open;
+    dist[( from.x - origin.x ) * SEEY + from.y - origin.y] = 0;
+    open.emplace( 0, from );
+    while( !open.empty() ) {
+        const std::pair<int, point> cur = open.top();
+        open.pop();
+        if( cur.first > dist[( cur.second.x - origin.x ) * SEEY + cur.second.y - origin.y] ) {
+            continue;
+        }
+        for( const tripoint &offset : eight_horizontal_neighbors ) {
+            const point d = offset.xy();
+            const point p = cur.second + d;
+            if( p.x < origin.x || p.y < origin.y || p.x >= origin.x + SEEX || p.y >= origin.y + SEEY ||
+                ( special[p.x][p.y] & PF_WALL ) ) {
+                continue;
+            }
+            // Same as map::route: flat ground costs 2, diagonals one more.
+            const int step = ( ( special[p.x][p.y] & PF_SLOW ) ? 4 : 2 ) + ( d.x != 0 && d.y != 0 ? 1 : 0 );
+            int &p_dist = dist[( p.x - origin.x ) * SEEY + p.y - origin.y];
+            if( p_dist < 0 || cur.first + step < p_dist ) {
+                p_dist = cur.first + step;
+                open.emplace( p_dist, p );
+            }
+        }
+    }
+    return dist;
+}
+
+static void build_submap_portals( pathfinding_portals::submap_portals &sm,
+                                  const pf_special_grid &special, const point &sm_pos, const int map_size )
+{
+    sm.portals.clear();
+    const point origin( sm_pos.x * SEEX, sm_pos.y * SEEY );
+
+    struct border {
+        point start;
+        point step;
+        int length;
+        point outward;
+    };
+    const std::array<border, 4> borders = {{
+            { origin, point_south, SEEY, point_west },
+            { origin + point( SEEX - 1, 0 ), point_south, SEEY, point_east },
+            { origin, point_east, SEEX, point_north },
+            { origin + point( 0, SEEY - 1 ), point_east, SEEX, point_south },
+        }
+    };
+    for( const border &b : borders ) {
+        const point neighbor = sm_pos + b.outward;
+        if( neighbor.x < 0 || neighbor.y < 0 || neighbor.x >= map_size || neighbor.y >= map_size ) {
+            continue;
+        }
+        // Both submaps find the same entrances, so they agree on the portals.
+        int run_start = -1;
+        for( int i = 0; i <= b.length; i++ ) {
+            bool open = false;
+            if( i < b.length ) {
+                const point inside = b.start + b.step * i;
+                const point outside = inside + b.outward;
+                open = !( special[inside.x][inside.y] & PF_WALL ) &&
+                       !( special[outside.x][outside.y] & PF_WALL );
+            }
+            if( open && run_start < 0 ) {
+                run_start = i;
+            } else if( !open && run_start >= 0 ) {
+                const point portal = b.start + b.step * ( ( run_start + i - 1 ) / 2 );
+                if( std::find( sm.portals.begin(), sm.portals.end(), portal ) == sm.portals.end() ) {
+                    sm.portals.push_back( portal );
+                }
+                run_start = -1;
+            }
+        }
+    }
+
+    const size_t count = sm.portals.size();
+    sm.costs.assign( count * count, -1 );
+    for( size_t i = 0; i < count; i++ ) {
+        const std::array<int, SEEX * SEEY> dist = submap_distances( special, sm.portals[i] );
+        for( size_t j = 0; j < count; j++ ) {
+            const point &to = sm.portals[j];
+            sm.costs[i * count + j] = dist[( to.x - origin.x ) * SEEY + to.y - origin.y];
+        }
+    }
+    sm.dirty = false;
+}
+
+static const pathfinding_portals::submap_portals &get_submap_portals( pathfinding_portals &portals,
+        const pf_special_grid &special, const int index, const int map_size )
+{
+    pathfinding_portals::submap_portals &sm = portals.submaps[index];
+    if( sm.dirty ) {
+        build_submap_portals( sm, special, point( index / MAPSIZE, index % MAPSIZE ), map_size );
+    }
+    return sm;
+}
+
+// Plans a route between tiles in different submaps of one z-level through the portals of
+// the submaps in between. Returns the indices of the submaps along the planned route, or
+// nothing if every route is blocked by walls.
+static std::vector<int> plan_submap_route( pathfinding_portals &portals, const pf_special_grid &special,
+        const int map_size, const point &f, const point &t )
+{
+    // Portal nodes are submap index * stride + portal index, there are at most
+    // two portals for every three tiles of a border.
+    constexpr int stride = 4 * std::max( SEEX, SEEY );
+    constexpr int start_node = -2;
+    constexpr int goal_node = -1;
+    const int f_sm = submap_index( f );
+    const int t_sm = submap_index( t );
+
+    std::unordered_map<int, int> gscore;
+    std::unordered_map<int, int> parent;
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_greater_cmp_first>
+    open;
+    const auto add_node = [&]( const int node, const int from, const int g, const point & pos ) {
+        const auto found = gscore.find( node );
+        if( found != gscore.end() && found->second <= g ) {
+            return;
+        }
+        gscore[node] = g;
+        parent[node] = from;
+        open.emplace( g + 2 * rl_dist( pos, t ), node );
+    };
+
+    const std::array<int, SEEX * SEEY> start_dist = submap_distances( special, f );
+    const std::array<int, SEEX * SEEY> goal_dist = submap_distances( special, t );
+    const point f_origin( f.x / SEEX * SEEX, f.y / SEEY * SEEY );
+    const point t_origin( t.x / SEEX * SEEX, t.y / SEEY * SEEY );
+    const auto &f_portals = get_submap_portals( portals, special, f_sm, map_size ).portals;
+    for( size_t i = 0; i < f_portals.size(); i++ ) {
+        const point &p = f_portals[i];
+        const int cost = start_dist[( p.x - f_origin.x ) * SEEY + p.y - f_origin.y];
+        if( cost >= 0 ) {
+            add_node( f_sm * stride + i, start_node, cost, p );
+        }
+    }
+
+    std::unordered_set<int> closed;
+    bool found_goal = false;
+    while( !open.empty() ) {
+        const int node = open.top().second;
+        open.pop();
+        if( node == goal_node ) {
+            found_goal = true;
+            break;
+        }
+        if( !closed.insert( node ).second ) {
+            continue;
+        }
+        const int g = gscore[node];
+        const int sm_index = node / stride;
+        const size_t portal = node % stride;
+        const auto &sm = get_submap_portals( portals, special, sm_index, map_size );
+        const point &pos = sm.portals[portal];
+
+        if( sm_index == t_sm ) {
+            const int cost = goal_dist[( pos.x - t_origin.x ) * SEEY + pos.y - t_origin.y];
+            if( cost >= 0 ) {
+                add_node( goal_node, node, g + cost, t );
+            }
+        }
+        const size_t count = sm.portals.size();
+        for( size_t other = 0; other < count; other++ ) {
+            const int cost = sm.costs[portal * count + other];
+            if( other != portal && cost >= 0 ) {
+                add_node( sm_index * stride + other, node, g + cost, sm.portals[other] );
+            }
+        }
+        // Step across the border onto the portal on the other side.
+        for( const point &d : four_adjacent_offsets ) {
+            const point across = pos + d;
+            if( across.x < 0 || across.y < 0 || across.x >= map_size * SEEX ||
+                across.y >= map_size * SEEY || submap_index( across ) == sm_index ) {
+                continue;
+            }
+            const int across_sm = submap_index( across );
+            const auto &across_portals = get_submap_portals( portals, special, across_sm, map_size ).portals;
+            const auto it = std::find( across_portals.begin(), across_portals.end(), across );
+            if( it != across_portals.end() ) {
+                add_node( across_sm * stride + ( it - across_portals.begin() ), node, g + 2, across );
+            }
+        }
+    }
+
+    std::vector<int> ret;
+    if( !found_goal ) {
+        return ret;
+    }
+    ret.push_back( t_sm );
+    for( int node = parent[goal_node]; node != start_node; node = parent[node] ) {
+        if( node / stride != ret.back() ) {
+            ret.push_back( node / stride );
+        }
+    }
+    if( ret.back() != f_sm ) {
+        ret.push_back( f_sm );
+    }
+    std::reverse( ret.begin(), ret.end() );
+    return ret;
+}
+
 std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                                   const pathfinding_settings &settings,
                                   const std::set<tripoint> &pre_closed ) const
@@ -197,7 +422,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     }
     // First, check for a simple straight line on flat ground
     // Except when the line contains a pre-closed tile - we need to do regular pathing then
-    static const auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP | PF_SHARP;
     if( f.z == t.z ) {
         const auto line_path = line_to( f, t );
         const auto &pf_cache = get_pathfinding_cache_ref( f.z );
@@ -218,13 +442,31 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         return ret;
     }
 
-    int max_length = settings.max_length;
-    int bash = settings.bash_strength;
-    int climb_cost = settings.climb_cost;
-    bool doors = settings.allow_open_doors;
-    bool trapavoid = settings.avoid_traps;
-    bool roughavoid = settings.avoid_rough_terrain;
-    bool sharpavoid = settings.avoid_sharp;
+    if( f.z == t.z && ( f.x / SEEX != t.x / SEEX || f.y / SEEY != t.y / SEEY ) ) {
+        // Plan the route submap by submap first, then only search the submaps along the plan.
+        // This finds routes around obstacles far bigger than the padding below.
+        const pf_special_grid &special = get_pathfinding_cache_ref( f.z ).special;
+        const std::vector<int> planned = plan_submap_route( get_pathfinding_cache( f.z ).portals,
+                                         special, my_MAPSIZE, f.xy(), t.xy() );
+        if( !planned.empty() ) {
+            std::bitset<MAPSIZE *MAPSIZE> corridor;
+            point min( MAPSIZE_X, MAPSIZE_Y );
+            point max( 0, 0 );
+            for( const int sm : planned ) {
+                corridor.set( sm );
+                const point sm_origin( sm / MAPSIZE * SEEX, sm % MAPSIZE * SEEY );
+                min = point( std::min( min.x, sm_origin.x ), std::min( min.y, sm_origin.y ) );
+                max = point( std::max( max.x, sm_origin.x + SEEX ), std::max( max.y, sm_origin.y + SEEY ) );
+            }
+            std::vector<tripoint> planned_route = route_in_area( f, t, settings, pre_closed,
+                                                  tripoint( min, f.z ), tripoint( max, f.z ), &corridor );
+            if( !planned_route.empty() ) {
+                return planned_route;
+            }
+        }
+        // The plan only knows about walls, the search below may still find a way through
+        // doors or bashable obstacles.
+    }
 
     const int pad = 16;  // Should be much bigger - low value makes pathfinders dumb!
     int minx = std::min( f.x, t.x ) - pad;
@@ -238,7 +480,264 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     clip_to_bounds( minx, miny, minz );
     clip_to_bounds( maxx, maxy, maxz );
 
-    pathfinder pf( minx, miny, maxx, maxy );
+    return route_in_area( f, t, settings, pre_closed, tripoint( minx, miny, minz ),
+                          tripoint( maxx, maxy, maxz ), nullptr );
+}
+
+int map::route_special_cost( const tripoint &cur, const tripoint &p, const pf_special p_special,
+                              const pathfinding_settings &settings, bool &close, bool &ledge ) const
+{
+    const int bash = settings.bash_strength;
+    const int climb_cost = settings.climb_cost;
+    const bool doors = settings.allow_open_doors;
+
+    if( settings.avoid_rough_terrain ) {
+        // Close all rough terrain tiles
+        close = true;
+        return -1;
+    }
+
+    int part = -1;
+    const maptile &tile = maptile_at_internal( p );
+    const auto &terrain = tile.get_ter_t();
+    const auto &furniture = tile.get_furn_t();
+    const vehicle *veh = veh_at_internal( p, part );
+
+    const int cost = move_cost_internal( furniture, terrain, veh, part );
+    // Don't calculate bash rating unless we intend to actually use it
+    const int rating = ( bash == 0 || cost != 0 ) ? -1 :
+                       bash_rating_internal( bash, furniture, terrain, false, veh, part );
+
+    if( cost == 0 && rating <= 0 && ( !doors || !terrain.open || !furniture.open ) && veh == nullptr &&
+        climb_cost <= 0 ) {
+        // Close it so that next time we won't try to calculate costs
+        close = true;
+        return -1;
+    }
+
+    int extra = cost;
+    if( cost == 0 ) {
+        if( climb_cost > 0 && p_special & PF_CLIMBABLE ) {
+            // Climbing fences
+            extra += climb_cost;
+        } else if( doors && ( terrain.open || furniture.open ) &&
+                   ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !furniture.has_flag( "OPENCLOSE_INSIDE" ) ||
+                     !is_outside( cur ) ) ) {
+            // Only try to open INSIDE doors from the inside
+            // To open and then move onto the tile
+            extra += 4;
+        } else if( veh != nullptr ) {
+            const auto vpobst = vpart_position( const_cast<vehicle &>( *veh ), part ).obstacle_at_part();
+            part = vpobst ? vpobst->part_index() : -1;
+            int dummy = -1;
+            if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
+                ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
+                  veh_at_internal( cur, dummy ) == veh ) ) {
+                // Handle car doors, but don't try to path through curtains
+                extra += 10; // One turn to open, 4 to move there
+            } else if( part >= 0 && bash > 0 ) {
+                // Car obstacle that isn't a door
+                // TODO: Account for armor
+                int hp = veh->parts[part].hp();
+                if( hp / 20 > bash ) {
+                    // Threshold damage thing means we just can't bash this down
+                    close = true;
+                    return -1;
+                } else if( hp / 10 > bash ) {
+                    // Threshold damage thing means we will fail to deal damage pretty often
+                    hp *= 2;
+                }
+
+                extra += 2 * hp / bash + 8 + 4;
+            } else if( part >= 0 ) {
+                if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
+                    // Won't be openable, don't try from other sides
+                    close = true;
+                }
+
+                return -1;
+            }
+        } else if( rating > 1 ) {
+            // Expected number of turns to bash it down, 1 turn to move there
+            // and 5 turns of penalty not to trash everything just because we can
+            extra += ( 20 / rating ) + 2 + 10;
+        } else if( rating == 1 ) {
+            // Desperate measures, avoid whenever possible
+            extra += 500;
+        } else {
+            // Unbashable and unopenable from here
+            if( !doors || !terrain.open || !furniture.open ) {
+                // Or anywhere else for that matter
+                close = true;
+            }
+
+            return -1;
+        }
+    }
+
+    if( settings.avoid_traps && p_special & PF_TRAP ) {
+        const auto &ter_trp = terrain.trap.obj();
+        const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
+        if( !trp.is_benign() ) {
+            // For now make them detect all traps
+            if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
+                // Warning: really expensive, needs a cache
+                if( valid_move( p, tripoint( p.xy(), p.z - 1 ), false, true ) ) {
+                    ledge = true;
+                    return -1;
+                }
+            } else {
+                // Otherwise it's walkable
+                extra += 500;
+            }
+        }
+    }
+
+    if( settings.avoid_sharp && p_special & PF_SHARP ) {
+        // Avoid sharp things
+        close = true;
+        return -1;
+    }
+
+    return extra;
+}
+
+// Whether two creatures pay the same for every step, only then they can share a flow field.
+static bool same_step_costs( const pathfinding_settings &a, const pathfinding_settings &b )
+{
+    return a.bash_strength == b.bash_strength && a.climb_cost == b.climb_cost &&
+           a.allow_open_doors == b.allow_open_doors && a.avoid_traps == b.avoid_traps &&
+           a.avoid_rough_terrain == b.avoid_rough_terrain && a.avoid_sharp == b.avoid_sharp;
+}
+
+std::vector<tripoint> map::shared_route( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings ) const
+{
+    if( f == t || f.z != t.z || !inbounds( f ) || !inbounds( t ) ||
+        rl_dist( f, t ) > settings.max_dist ) {
+        return route( f, t, settings );
+    }
+
+    if( flow_fields_turn != calendar::turn ) {
+        clear_flow_fields();
+        flow_fields_turn = calendar::turn;
+    }
+    const pathfinding_flow_field *field = nullptr;
+    for( const std::unique_ptr<pathfinding_flow_field> &candidate : flow_fields ) {
+        if( candidate->goal == t && same_step_costs( candidate->settings, settings ) ) {
+            field = candidate.get();
+            break;
+        }
+    }
+    if( field == nullptr ) {
+        const auto request = std::find_if( flow_field_requests.begin(), flow_field_requests.end(),
+        [&t, &settings]( const std::pair<tripoint, pathfinding_settings> &elem ) {
+            return elem.first == t && same_step_costs( elem.second, settings );
+        } );
+        if( request == flow_field_requests.end() ) {
+            // A single creature is much faster with the bounded search.
+            flow_field_requests.emplace_back( t, settings );
+            return route( f, t, settings );
+        }
+        flow_field_requests.erase( request );
+        flow_fields.emplace_back( build_flow_field( t, settings ) );
+        field = flow_fields.back().get();
+    }
+
+    std::vector<tripoint> ret;
+    int index = flat_index( f.x, f.y );
+    if( field->dist[index] < 0 || field->dist[index] > settings.max_length ) {
+        return ret;
+    }
+    const int goal_index = flat_index( t.x, t.y );
+    while( index != goal_index ) {
+        index = field->next[index];
+        ret.emplace_back( index / MAPSIZE_Y, index % MAPSIZE_Y, t.z );
+    }
+    return ret;
+}
+
+void map::clear_flow_fields() const
+{
+    flow_fields.clear();
+    flow_field_requests.clear();
+}
+
+std::unique_ptr<pathfinding_flow_field> map::build_flow_field( const tripoint &t,
+        const pathfinding_settings &settings ) const
+{
+    auto field = std::make_unique<pathfinding_flow_field>();
+    field->goal = t;
+    field->settings = settings;
+    field->dist.fill( -1 );
+    field->next.fill( -1 );
+
+    const auto &pf_cache = get_pathfinding_cache_ref( t.z );
+    const int size_x = SEEX * my_MAPSIZE;
+    const int size_y = SEEY * my_MAPSIZE;
+
+    // Dijkstra backwards from the goal, with the step costs of route_in_area.
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, pair_greater_cmp_first>
+    open;
+    field->dist[flat_index( t.x, t.y )] = 0;
+    open.emplace( 0, flat_index( t.x, t.y ) );
+    while( !open.empty() ) {
+        const std::pair<int, int> top = open.top();
+        open.pop();
+        const int to_index = top.second;
+        if( top.first > field->dist[to_index] ) {
+            continue;
+        }
+        const tripoint to( to_index / MAPSIZE_Y, to_index % MAPSIZE_Y, t.z );
+        const pf_special to_special = pf_cache.special[to.x][to.y];
+        for( const tripoint &offset : eight_horizontal_neighbors ) {
+            const tripoint from = to + offset;
+            if( from.x < 0 || from.y < 0 || from.x >= size_x || from.y >= size_y ) {
+                continue;
+            }
+            // Penalize for diagonals or the path will look "unnatural"
+            int cost = ( offset.x != 0 && offset.y != 0 ) ? 1 : 0;
+            if( !( to_special & non_normal ) ) {
+                cost += 2;
+            } else {
+                bool close = false;
+                bool ledge = false;
+                const int special_cost = route_special_cost( from, to, to_special, settings, close, ledge );
+                if( special_cost < 0 ) {
+                    continue;
+                }
+                cost += special_cost;
+            }
+            const int from_index = flat_index( from.x, from.y );
+            const int from_dist = top.first + cost;
+            if( field->dist[from_index] < 0 || from_dist < field->dist[from_index] ) {
+                field->dist[from_index] = from_dist;
+                field->next[from_index] = to_index;
+                open.emplace( from_dist, from_index );
+            }
+        }
+    }
+    return field;
+}
+
+std::vector<tripoint> map::route_in_area( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed,
+        const tripoint &min, const tripoint &max,
+        const std::bitset<MAPSIZE *MAPSIZE> *corridor ) const
+{
+    std::vector<tripoint> ret;
+
+    int max_length = settings.max_length;
+
+    const int minx = min.x;
+    const int miny = min.y;
+    const int minz = min.z;
+    const int maxx = max.x;
+    const int maxy = max.y;
+    const int maxz = max.z;
+
+    pathfinder pf( minx, miny, maxx - 1, maxy - 1 );
     // Make NPCs not want to path through player
     // But don't make player pathing stop working
     for( const auto &p : pre_closed ) {
@@ -292,6 +791,9 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
             if( p.x < minx || p.x >= maxx || p.y < miny || p.y >= maxy ) {
                 continue;
             }
+            if( corridor != nullptr && !corridor->test( p.x / SEEX * MAPSIZE + p.y / SEEY ) ) {
+                continue;
+            }
 
             if( layer.state[index] == ASL_CLOSED ) {
                 continue;
@@ -306,122 +808,32 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                 // Boring flat dirt - the most common case above the ground
                 newg += 2;
             } else {
-                if( roughavoid ) {
-                    layer.state[index] = ASL_CLOSED; // Close all rough terrain tiles
-                    continue;
-                }
-
-                int part = -1;
-                const maptile &tile = maptile_at_internal( p );
-                const auto &terrain = tile.get_ter_t();
-                const auto &furniture = tile.get_furn_t();
-                const vehicle *veh = veh_at_internal( p, part );
-
-                const int cost = move_cost_internal( furniture, terrain, veh, part );
-                // Don't calculate bash rating unless we intend to actually use it
-                const int rating = ( bash == 0 || cost != 0 ) ? -1 :
-                                   bash_rating_internal( bash, furniture, terrain, false, veh, part );
+                bool close = false;
+                bool ledge = false;
+                const int special_cost = route_special_cost( cur, p, p_special, settings, close, ledge );
+                if( ledge ) {
+                    // Special case - ledge in z-levels
+                    tripoint below( p.xy(), p.z - 1 );
+                    if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
+                        // Otherwise this would have been a huge fall
+                        auto &layer = pf.get_layer( p.z - 1 );
+                        // From cur, not p, because we won't be walking on air
+                        pf.add_point( layer.gscore[parent_index] + 10,
+                                      layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
+                                      cur, below );
+                    }
 
-                if( cost == 0 && rating <= 0 && ( !doors || !terrain.open || !furniture.open ) && veh == nullptr &&
-                    climb_cost <= 0 ) {
-                    layer.state[index] = ASL_CLOSED; // Close it so that next time we won't try to calculate costs
+                    // Close p, because we won't be walking on it
+                    layer.state[index] = ASL_CLOSED;
                     continue;
                 }
-
-                newg += cost;
-                if( cost == 0 ) {
-                    if( climb_cost > 0 && p_special & PF_CLIMBABLE ) {
-                        // Climbing fences
-                        newg += climb_cost;
-                    } else if( doors && ( terrain.open || furniture.open ) &&
-                               ( !terrain.has_flag( "OPENCLOSE_INSIDE" ) || !furniture.has_flag( "OPENCLOSE_INSIDE" ) ||
-                                 !is_outside( cur ) ) ) {
-                        // Only try to open INSIDE doors from the inside
-                        // To open and then move onto the tile
-                        newg += 4;
-                    } else if( veh != nullptr ) {
-                        const auto vpobst = vpart_position( const_cast<vehicle &>( *veh ), part ).obstacle_at_part();
-                        part = vpobst ? vpobst->part_index() : -1;
-                        int dummy = -1;
-                        if( doors && veh->part_flag( part, VPFLAG_OPENABLE ) &&
-                            ( !veh->part_flag( part, "OPENCLOSE_INSIDE" ) ||
-                              veh_at_internal( cur, dummy ) == veh ) ) {
-                            // Handle car doors, but don't try to path through curtains
-                            newg += 10; // One turn to open, 4 to move there
-                        } else if( part >= 0 && bash > 0 ) {
-                            // Car obstacle that isn't a door
-                            // TODO: Account for armor
-                            int hp = veh->parts[part].hp();
-                            if( hp / 20 > bash ) {
-                                // Threshold damage thing means we just can't bash this down
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            } else if( hp / 10 > bash ) {
-                                // Threshold damage thing means we will fail to deal damage pretty often
-                                hp *= 2;
-                            }
-
-                            newg += 2 * hp / bash + 8 + 4;
-                        } else if( part >= 0 ) {
-                            if( !doors || !veh->part_flag( part, VPFLAG_OPENABLE ) ) {
-                                // Won't be openable, don't try from other sides
-                                layer.state[index] = ASL_CLOSED;
-                            }
-
-                            continue;
-                        }
-                    } else if( rating > 1 ) {
-                        // Expected number of turns to bash it down, 1 turn to move there
-                        // and 5 turns of penalty not to trash everything just because we can
-                        newg += ( 20 / rating ) + 2 + 10;
-                    } else if( rating == 1 ) {
-                        // Desperate measures, avoid whenever possible
-                        newg += 500;
-                    } else {
-                        // Unbashable and unopenable from here
-                        if( !doors || !terrain.open || !furniture.open ) {
-                            // Or anywhere else for that matter
-                            layer.state[index] = ASL_CLOSED;
-                        }
-
-                        continue;
-                    }
+                if( close ) {
+                    layer.state[index] = ASL_CLOSED;
                 }
-
-                if( trapavoid && p_special & PF_TRAP ) {
-                    const auto &ter_trp = terrain.trap.obj();
-                    const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
-                    if( !trp.is_benign() ) {
-                        // For now make them detect all traps
-                        if( has_zlevels() && terrain.has_flag( TFLAG_NO_FLOOR ) ) {
-                            // Special case - ledge in z-levels
-                            // Warning: really expensive, needs a cache
-                            if( valid_move( p, tripoint( p.xy(), p.z - 1 ), false, true ) ) {
-                                tripoint below( p.xy(), p.z - 1 );
-                                if( !has_flag( TFLAG_NO_FLOOR, below ) ) {
-                                    // Otherwise this would have been a huge fall
-                                    auto &layer = pf.get_layer( p.z - 1 );
-                                    // From cur, not p, because we won't be walking on air
-                                    pf.add_point( layer.gscore[parent_index] + 10,
-                                                  layer.score[parent_index] + 10 + 2 * rl_dist( below, t ),
-                                                  cur, below );
-                                }
-
-                                // Close p, because we won't be walking on it
-                                layer.state[index] = ASL_CLOSED;
-                                continue;
-                            }
-                        } else if( trapavoid ) {
-                            // Otherwise it's walkable
-                            newg += 500;
-                        }
-                    }
-                }
-
-                if( sharpavoid && p_special & PF_SHARP ) {
-                    layer.state[index] = ASL_CLOSED; // Avoid sharp things
+                if( special_cost < 0 ) {
+                    continue;
                 }
-
+                newg += special_cost;
             }
 
             // If not visited, add as open
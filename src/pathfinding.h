@@ -2,7 +2,11 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include <array>
+#include <vector>
+
 #include "game_constants.h"
+#include "point.h"
 
 enum pf_special : int {
     PF_NORMAL = 0x00,    // Plain boring tile (grass, dirt, floor etc.)
@@ -38,6 +42,30 @@ inline pf_special &operator &= ( pf_special &lhs, pf_special rhs )
     return lhs;
 }
 
+/**
+ * Abstract graph of a z-level used to plan long routes submap by submap before searching
+ * for the actual path (hierarchical A*).
+ *
+ * The border between two neighboring submaps is split into entrances, runs of tiles that
+ * are no walls on either side. The middle tile of an entrance is a portal on both sides.
+ */
+struct pathfinding_portals {
+    struct submap_portals {
+        /** Portal tiles, in map coordinates. */
+        std::vector<point> portals;
+        /**
+         * Cost of walking from portal i to portal j without leaving the submap is at
+         * i * portals.size() + j, -1 if that isn't possible.
+         */
+        std::vector<int> costs;
+        /** Needs to be rebuilt from @ref pathfinding_cache::special before the next use. */
+        bool dirty = true;
+    };
+
+    /** Indexed by submap x * MAPSIZE + submap y. */
+    std::array<submap_portals, MAPSIZE *MAPSIZE> submaps;
+};
+
 struct pathfinding_cache {
     pathfinding_cache();
     ~pathfinding_cache();
@@ -45,6 +73,9 @@ struct pathfinding_cache {
     bool dirty;
 
     pf_special special[MAPSIZE_X][MAPSIZE_Y];
+
+    /** Only the submaps whose tiles (or neighbors) changed get marked dirty. */
+    pathfinding_portals portals;
 };
 
 struct pathfinding_settings {
@@ -72,4 +103,14 @@ struct pathfinding_settings {
           avoid_sharp( as ) {}
 };
 
+/** The way to one goal tile from every tile of its z-level, see @ref map::shared_route. */
+struct pathfinding_flow_field {
+    tripoint goal;
+    pathfinding_settings settings;
+    /** Cost of getting from a tile (x * MAPSIZE_Y + y) to the goal, -1 if that isn't possible. */
+    std::array<int, MAPSIZE_X *MAPSIZE_Y> dist;
+    /** Next tile on the way to the goal, as index like above. */
+    std::array<int, MAPSIZE_X *MAPSIZE_Y> next;
+};
+
 #endif
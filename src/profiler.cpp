@@ -0,0 +1,172 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+#include "cata_utility.h"
+#include "json.h"
+
+namespace
+{
+
+std::atomic<bool> profiling_enabled{ false };
+std::atomic<uint32_t> next_thread_number{ 0 };
+
+const profiler::clock::time_point &epoch()
+{
+    static const profiler::clock::time_point start = profiler::clock::now();
+    return start;
+}
+
+uint32_t thread_number()
+{
+    static thread_local const uint32_t number = next_thread_number.fetch_add( 1 );
+    return number;
+}
+
+struct zone_registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<profiler::zone>> zones;
+};
+
+zone_registry &registry()
+{
+    static zone_registry instance;
+    return instance;
+}
+
+} // namespace
+
+profiler::zone::zone( const char *name ) : name_( name )
+{
+}
+
+void profiler::zone::record( const int64_t start_ns, const int64_t duration_ns )
+{
+    slot &s = ring[next.fetch_add( 1, std::memory_order_relaxed ) % ring_size];
+    s.start_ns.store( start_ns, std::memory_order_relaxed );
+    s.duration_ns.store( duration_ns, std::memory_order_relaxed );
+    s.thread.store( thread_number(), std::memory_order_relaxed );
+
+    calls_.fetch_add( 1, std::memory_order_relaxed );
+    total_ns_.fetch_add( duration_ns, std::memory_order_relaxed );
+    int64_t longest = max_ns_.load( std::memory_order_relaxed );
+    while( duration_ns > longest &&
+           !max_ns_.compare_exchange_weak( longest, duration_ns, std::memory_order_relaxed ) ) {
+    }
+}
+
+void profiler::zone::reset()
+{
+    next.store( 0 );
+    calls_.store( 0 );
+    total_ns_.store( 0 );
+    max_ns_.store( 0 );
+}
+
+std::vector<profiler::sample> profiler::zone::samples() const
+{
+    const uint64_t end = next.load( std::memory_order_relaxed );
+    const uint64_t count = std::min<uint64_t>( end, ring_size );
+    std::vector<sample> result;
+    result.reserve( count );
+    for( uint64_t i = end - count; i < end; ++i ) {
+        const slot &s = ring[i % ring_size];
+        result.push_back( { s.start_ns.load( std::memory_order_relaxed ),
+                            s.duration_ns.load( std::memory_order_relaxed ),
+                            s.thread.load( std::memory_order_relaxed )
+                          } );
+    }
+    return result;
+}
+
+int64_t profiler::zone::percentile( const int pct ) const
+{
+    std::vector<int64_t> durations;
+    for( const sample &s : samples() ) {
+        durations.push_back( s.duration_ns );
+    }
+    if( durations.empty() ) {
+        return 0;
+    }
+    const size_t nth = std::min( durations.size() - 1,
+                                 durations.size() * static_cast<size_t>( std::max( pct, 0 ) ) / 100 );
+    std::nth_element( durations.begin(), durations.begin() + nth, durations.end() );
+    return durations[nth];
+}
+
+profiler::zone &profiler::get_zone( const char *name )
+{
+    zone_registry &reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+    for( const std::unique_ptr<zone> &z : reg.zones ) {
+        if( std::string( z->name() ) == name ) {
+            return *z;
+        }
+    }
+    reg.zones.emplace_back( std::make_unique<zone>( name ) );
+    return *reg.zones.back();
+}
+
+std::vector<profiler::zone *> profiler::all_zones()
+{
+    zone_registry &reg = registry();
+    std::lock_guard<std::mutex> lock( reg.mutex );
+    std::vector<zone *> result;
+    for( const std::unique_ptr<zone> &z : reg.zones ) {
+        result.push_back( z.get() );
+    }
+    return result;
+}
+
+void profiler::reset()
+{
+    for( zone *z : all_zones() ) {
+        z->reset();
+    }
+}
+
+bool profiler::enabled()
+{
+    return profiling_enabled.load( std::memory_order_relaxed );
+}
+
+void profiler::set_enabled( const bool enable )
+{
+    // Make sure the epoch predates the first sample.
+    epoch();
+    profiling_enabled.store( enable );
+}
+
+int64_t profiler::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( clock::now() - epoch() ).count();
+}
+
+bool profiler::write_chrome_trace( const std::string &path )
+{
+    return write_to_file( path, [&]( std::ostream & fout ) {
+        JsonOut jsout( fout );
+        jsout.start_object();
+        jsout.member( "displayTimeUnit", std::string( "ms" ) );
+        jsout.member( "traceEvents" );
+        jsout.start_array();
+        for( const zone *z : all_zones() ) {
+            for( const sample &s : z->samples() ) {
+                // Complete events, timestamps are in microseconds.
+                jsout.start_object();
+                jsout.member( "name", std::string( z->name() ) );
+                jsout.member( "ph", std::string( "X" ) );
+                jsout.member( "pid", 1 );
+                jsout.member( "tid", s.thread );
+                jsout.member( "ts", s.start_ns / 1000.0 );
+                jsout.member( "dur", s.duration_ns / 1000.0 );
+                jsout.end_object();
+            }
+        }
+        jsout.end_array();
+        jsout.end_object();
+    }, nullptr );
+}
@@ -0,0 +1,136 @@
+#pragma once
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Scoped profiling zones.
+ *
+ * A zone is declared with @ref CATA_PROFILE_ZONE at the top of the scope that should be timed.
+ * Zones always get compiled in (unless `CATA_NO_PROFILING` is defined) but only record
+ * anything after @ref profiler::set_enabled has been called, so an idle zone costs a single
+ * relaxed atomic load.
+ *
+ * Every zone keeps its last @ref profiler::ring_size samples in a lock-free ring buffer,
+ * zones may therefore be entered from any thread.
+ */
+namespace profiler
+{
+
+using clock = std::chrono::steady_clock;
+
+constexpr size_t ring_size = 256;
+
+struct sample {
+    /** Nanoseconds since the profiler was first used. */
+    int64_t start_ns;
+    int64_t duration_ns;
+    /** Small number identifying the thread the zone was entered on. */
+    uint32_t thread;
+};
+
+class zone
+{
+    public:
+        explicit zone( const char *name );
+        zone( const zone & ) = delete;
+        zone &operator=( const zone & ) = delete;
+
+        void record( int64_t start_ns, int64_t duration_ns );
+        /** Forgets all samples and totals. */
+        void reset();
+
+        const char *name() const {
+            return name_;
+        }
+        /** The samples currently in the ring buffer, oldest first. */
+        std::vector<sample> samples() const;
+        /** Duration in nanoseconds at the given percentile (0-100) of the buffered samples. */
+        int64_t percentile( int pct ) const;
+
+        uint64_t calls() const {
+            return calls_.load( std::memory_order_relaxed );
+        }
+        int64_t total_ns() const {
+            return total_ns_.load( std::memory_order_relaxed );
+        }
+        int64_t max_ns() const {
+            return max_ns_.load( std::memory_order_relaxed );
+        }
+
+    private:
+        struct slot {
+            std::atomic<int64_t> start_ns{ 0 };
+            std::atomic<int64_t> duration_ns{ 0 };
+            std::atomic<uint32_t> thread{ 0 };
+        };
+
+        const char *name_;
+        std::array<slot, ring_size> ring;
+        std::atomic<uint64_t> next{ 0 };
+        std::atomic<uint64_t> calls_{ 0 };
+        std::atomic<int64_t> total_ns_{ 0 };
+        std::atomic<int64_t> max_ns_{ 0 };
+};
+
+/** Returns the zone with the given name, creating it on first use. */
+zone &get_zone( const char *name );
+/** All zones created so far, in order of creation. */
+std::vector<zone *> all_zones();
+/** Forgets the samples and totals of all zones. */
+void reset();
+
+bool enabled();
+void set_enabled( bool enable );
+
+/** Nanoseconds since the profiler was first used. */
+int64_t now_ns();
+
+/**
+ * Writes the buffered samples of all zones in the Chrome trace event format,
+ * which can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * @return Whether the file could be written.
+ */
+bool write_chrome_trace( const std::string &path );
+
+class scoped_zone
+{
+    public:
+        explicit scoped_zone( zone &z ) : z( z ), start_ns( enabled() ? now_ns() : -1 ) {
+        }
+        ~scoped_zone() {
+            if( start_ns >= 0 ) {
+                z.record( start_ns, now_ns() - start_ns );
+            }
+        }
+        scoped_zone( const scoped_zone & ) = delete;
+        scoped_zone &operator=( const scoped_zone & ) = delete;
+
+    private:
+        zone &z;
+        const int64_t start_ns;
+};
+
+} // namespace profiler
+
+#define CATA_PROFILE_CONCAT_IMPL( a, b ) a##b
+#define CATA_PROFILE_CONCAT( a, b ) CATA_PROFILE_CONCAT_IMPL( a, b )
+
+#if defined(CATA_NO_PROFILING)
+#define CATA_PROFILE_ZONE( zone_name ) do {} while( false )
+#else
+/** Times the rest of the enclosing scope as the zone @p zone_name (a string literal). */
+#define CATA_PROFILE_ZONE( zone_name ) \
+    static profiler::zone &CATA_PROFILE_CONCAT( cata_profile_zone_, __LINE__ ) = \
+            profiler::get_zone( zone_name ); \
+    profiler::scoped_zone CATA_PROFILE_CONCAT( cata_profile_scope_, __LINE__ )( \
+            CATA_PROFILE_CONCAT( cata_profile_zone_, __LINE__ ) )
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,251 @@
+#include "region_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "background_save.h"
+#include "string_formatter.h"
+
+namespace
+{
+
+const std::string region_magic = "CATAREG2";
+// Files with a single table, they are rewritten in the current format when they are written.
+const std::string region_magic_v1 = "CATAREG1";
+constexpr uint64_t magic_size = 8;
+// Offset (8 bytes) and length (4 bytes), both little endian.
+constexpr uint64_t table_entry_size = 12;
+constexpr uint64_t table_size = region_file::entries * table_entry_size;
+// Each table slot starts with its generation (8 bytes, little endian).
+constexpr uint64_t generation_size = 8;
+constexpr uint64_t slot_size = generation_size + table_size;
+constexpr uint64_t header_size = magic_size + 2 * slot_size;
+// Garbage below this size is not worth rewriting the file for.
+constexpr uint64_t min_compact_garbage = 64 * 1024;
+
+void encode( char *const out, const uint64_t value, const int bytes )
+{
+    for( int i = 0; i < bytes; i++ ) {
+        out[i] = static_cast<char>( ( value >> ( 8 * i ) ) & 0xff );
+    }
+}
+
+uint64_t decode( const char *const in, const int bytes )
+{
+    uint64_t value = 0;
+    for( int i = 0; i < bytes; i++ ) {
+        value |= static_cast<uint64_t>( static_cast<unsigned char>( in[i] ) ) << ( 8 * i );
+    }
+    return value;
+}
+
+void check_index( const std::string &path, const int index )
+{
+    if( index < 0 || index >= region_file::entries ) {
+        throw std::out_of_range( string_format( "invalid entry %d of region file %s", index, path ) );
+    }
+}
+
+uint64_t slot_offset( const int slot )
+{
+    return magic_size + slot * slot_size;
+}
+
+// The slot with the current table, given the generations of both slots.
+int current_slot( const uint64_t generation0, const uint64_t generation1 )
+{
+    return generation1 > generation0 ? 1 : 0;
+}
+
+// Closes the file when it goes out of scope.
+struct file_closer {
+    void operator()( std::FILE *const file ) const {
+        std::fclose( file );
+    }
+};
+using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+void write_at( std::FILE *const file, const uint64_t offset, const char *const data,
+               const size_t size, const std::string &path )
+{
+    if( std::fseek( file, static_cast<long>( offset ), SEEK_SET ) != 0 ||
+        std::fwrite( data, 1, size, file ) != size ) {
+        throw std::runtime_error( string_format( "failed to write region file %s", path ) );
+    }
+}
+
+void sync( std::FILE *const file, const std::string &path )
+{
+    if( !background_save::flush_to_disk( file ) ) {
+        throw std::runtime_error( string_format( "failed to write region file %s", path ) );
+    }
+}
+
+} // namespace
+
+region_file::region_file( const std::string &path ) : path( path )
+{
+}
+
+bool region_file::read( const int index, std::string &data ) const
+{
+    check_index( path, index );
+    std::ifstream fin( path, std::ios::binary );
+    if( !fin.is_open() ) {
+        return false;
+    }
+    std::string magic( magic_size, '\0' );
+    fin.read( &magic[0], magic.size() );
+    uint64_t entry_offset = 0;
+    if( fin && magic == region_magic ) {
+        char raw_generation[generation_size];
+        fin.seekg( slot_offset( 0 ) );
+        fin.read( raw_generation, generation_size );
+        const uint64_t generation0 = decode( raw_generation, generation_size );
+        fin.seekg( slot_offset( 1 ) );
+        fin.read( raw_generation, generation_size );
+        const uint64_t generation1 = decode( raw_generation, generation_size );
+        entry_offset = slot_offset( current_slot( generation0, generation1 ) ) + generation_size;
+    } else if( fin && magic == region_magic_v1 ) {
+        entry_offset = magic_size;
+    } else {
+        throw std::runtime_error( string_format( "%s is not a region file", path ) );
+    }
+    char raw_entry[table_entry_size];
+    fin.seekg( entry_offset + index * table_entry_size );
+    fin.read( raw_entry, table_entry_size );
+    const uint64_t offset = decode( raw_entry, 8 );
+    const uint64_t length = decode( raw_entry + 8, 4 );
+    if( !fin || length == 0 ) {
+        return false;
+    }
+    data.resize( length );
+    fin.seekg( offset );
+    fin.read( &data[0], length );
+    if( !fin ) {
+        throw std::runtime_error( string_format( "failed to read entry %d of region file %s", index,
+                                  path ) );
+    }
+    return true;
+}
+
+void region_file::write( const std::map<int, std::string> &data )
+{
+    file_ptr file( std::fopen( path.c_str(), "r+b" ) );
+    if( !file ) {
+        std::string empty( header_size, '\0' );
+        empty.replace( 0, magic_size, region_magic );
+        encode( &empty[slot_offset( 0 )], 1, generation_size );
+        background_save::write_synced( path, empty );
+        file.reset( std::fopen( path.c_str(), "r+b" ) );
+        if( !file ) {
+            throw std::runtime_error( string_format( "failed to open region file %s", path ) );
+        }
+    }
+
+    std::string header( header_size, '\0' );
+    size_t header_read = std::fread( &header[0], 1, header.size(), file.get() );
+    std::vector<table_entry> table( entries );
+    if( header_read >= magic_size + table_size &&
+        header.compare( 0, magic_size, region_magic_v1 ) == 0 ) {
+        // Rewritten with the two table slots, then written like any other file.
+        for( int i = 0; i < entries; i++ ) {
+            table[i].offset = decode( &header[magic_size + i * table_entry_size], 8 );
+            table[i].length = decode( &header[magic_size + i * table_entry_size + 8], 4 );
+        }
+        file.reset();
+        compact( table.data() );
+        file.reset( std::fopen( path.c_str(), "r+b" ) );
+        header_read = file ? std::fread( &header[0], 1, header.size(), file.get() ) : 0;
+    }
+    if( header_read != header.size() || header.compare( 0, magic_size, region_magic ) != 0 ) {
+        throw std::runtime_error( string_format( "%s is not a region file", path ) );
+    }
+    const uint64_t generation0 = decode( &header[slot_offset( 0 )], generation_size );
+    const uint64_t generation1 = decode( &header[slot_offset( 1 )], generation_size );
+    const int slot = current_slot( generation0, generation1 );
+    const char *const raw_table = &header[slot_offset( slot ) + generation_size];
+    for( int i = 0; i < entries; i++ ) {
+        table[i].offset = decode( raw_table + i * table_entry_size, 8 );
+        table[i].length = decode( raw_table + i * table_entry_size + 8, 4 );
+    }
+
+    if( std::fseek( file.get(), 0, SEEK_END ) != 0 ) {
+        throw std::runtime_error( string_format( "failed to write region file %s", path ) );
+    }
+    uint64_t end = std::ftell( file.get() );
+    for( const auto &entry : data ) {
+        check_index( path, entry.first );
+        if( entry.second.size() > UINT32_MAX ) {
+            throw std::length_error( string_format( "entry %d of region file %s is too big", entry.first,
+                                                    path ) );
+        }
+        table_entry &dest = table[entry.first];
+        dest.offset = entry.second.empty() ? 0 : end;
+        dest.length = entry.second.size();
+        write_at( file.get(), end, entry.second.data(), entry.second.size(), path );
+        end += entry.second.size();
+    }
+    // The data has to be on the disk before a table points to it.
+    sync( file.get(), path );
+
+    // The new table goes into the other slot, the current one stays intact until the new
+    // one is complete on the disk.
+    const int new_slot = 1 - slot;
+    std::string new_table( table_size, '\0' );
+    uint64_t live_size = 0;
+    for( int i = 0; i < entries; i++ ) {
+        encode( &new_table[i * table_entry_size], table[i].offset, 8 );
+        encode( &new_table[i * table_entry_size + 8], table[i].length, 4 );
+        live_size += table[i].length;
+    }
+    write_at( file.get(), slot_offset( new_slot ) + generation_size, new_table.data(),
+              new_table.size(), path );
+    sync( file.get(), path );
+    char raw_generation[generation_size];
+    encode( raw_generation, std::max( generation0, generation1 ) + 1, generation_size );
+    write_at( file.get(), slot_offset( new_slot ), raw_generation, generation_size, path );
+    sync( file.get(), path );
+    if( std::fclose( file.release() ) != 0 ) {
+        throw std::runtime_error( string_format( "failed to write region file %s", path ) );
+    }
+
+    const uint64_t garbage = end - header_size - live_size;
+    if( garbage > live_size && garbage > min_compact_garbage ) {
+        compact( table.data() );
+    }
+}
+
+void region_file::compact( const table_entry *const table )
+{
+    std::ifstream fin( path, std::ios::binary );
+    std::string header( header_size, '\0' );
+    header.replace( 0, magic_size, region_magic );
+    encode( &header[slot_offset( 0 )], 1, generation_size );
+    char *const raw_table = &header[slot_offset( 0 ) + generation_size];
+    std::string entry_data;
+    std::string buffer;
+    for( int i = 0; i < entries; i++ ) {
+        encode( raw_table + i * table_entry_size,
+                table[i].length == 0 ? 0 : header_size + entry_data.size(), 8 );
+        encode( raw_table + i * table_entry_size + 8, table[i].length, 4 );
+        if( table[i].length == 0 ) {
+            continue;
+        }
+        buffer.resize( table[i].length );
+        fin.seekg( table[i].offset );
+        fin.read( &buffer[0], buffer.size() );
+        if( !fin ) {
+            throw std::runtime_error( string_format( "failed to read entry %d of region file %s", i,
+                                      path ) );
+        }
+        entry_data += buffer;
+    }
+    fin.close();
+    // The new file replaces the old one only once it is completely on the disk.
+    background_save::write_synced( path, header + entry_data );
+}
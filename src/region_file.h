@@ -0,0 +1,55 @@
+#pragma once
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * A single file holding many numbered entries of data, used to store all saved submap
+ * quads of a map segment in one file instead of one file per quad.
+ *
+ * The file starts with two slots for the table of the offset and length of every entry,
+ * each with a generation counter, the data of the entries follows behind them. The slot
+ * with the higher generation is the current table. Writing entries appends the new data and
+ * syncs it to disk, then it writes the new table into the other slot and syncs that, and
+ * only then it increments the generation of that slot. Whenever the game crashes, one of the
+ * tables is complete and points at data that is on the disk. The old data stays behind as
+ * garbage until it takes up more space than the live data, then the file is compacted into
+ * a new file that replaces the old one.
+ *
+ * All functions throw std::exception on I/O errors.
+ */
+class region_file
+{
+    public:
+        /** Number of entries in each file. */
+        static constexpr int entries = 32 * 32;
+
+        explicit region_file( const std::string &path );
+
+        /**
+         * Reads the data of the entry @p index into @p data.
+         * @return false if the file or the entry does not exist.
+         */
+        bool read( int index, std::string &data ) const;
+        /**
+         * Replaces the data of the given entries, an empty string removes the entry.
+         * Creates the file if needed.
+         */
+        void write( const std::map<int, std::string> &data );
+
+    private:
+        struct table_entry {
+            uint64_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        /** Writes a new file with the live entries of @p table, read from the current file. */
+        void compact( const table_entry *table );
+
+        std::string path;
+};
+
+#endif // REGION_FILE_H
@@ -91,6 +91,8 @@ void game::serialize( std::ostream &fout )
 
     json.member( "grscent", scent.serialize() );
     json.member( "typescent", scent.serialize( true ) );
+    json.member( "scent_layers" );
+    scent.serialize_layers( json );
 
     // Then each monster
     json.member( "active_monsters", *critter_tracker );
@@ -108,32 +110,54 @@ void game::serialize( std::ostream &fout )
 
 std::string scent_map::serialize( bool is_type ) const
 {
-    std::stringstream rle_out;
     if( is_type ) {
-        rle_out << typescent.str();
-    } else {
-        int rle_lastval = -1;
-        int rle_count = 0;
-        for( auto &elem : grscent ) {
-            for( auto &val : elem ) {
-                if( val == rle_lastval ) {
-                    rle_count++;
-                } else {
-                    if( rle_count ) {
-                        rle_out << rle_count << " ";
-                    }
-                    rle_out << val << " ";
-                    rle_lastval = val;
-                    rle_count = 1;
+        return typescent.str();
+    }
+    return serialize_layer( layer_at( gm.get_levz() ) );
+}
+
+std::string scent_map::serialize_layer( const scent_layer *layer ) const
+{
+    std::stringstream rle_out;
+    int rle_lastval = -1;
+    int rle_count = 0;
+    for( size_t x = 0; x < MAPSIZE_X; ++x ) {
+        for( size_t y = 0; y < MAPSIZE_Y; ++y ) {
+            const int val = layer != nullptr ? std::max( 0, layer->values[x][y] - decay_offset ) : 0;
+            if( val == rle_lastval ) {
+                rle_count++;
+            } else {
+                if( rle_count ) {
+                    rle_out << rle_count << " ";
                 }
+                rle_out << val << " ";
+                rle_lastval = val;
+                rle_count = 1;
             }
         }
-        rle_out << rle_count;
     }
+    rle_out << rle_count;
 
     return rle_out.str();
 }
 
+void scent_map::serialize_layers( JsonOut &jsout ) const
+{
+    const int levz = gm.get_levz();
+    jsout.start_array();
+    for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; ++z ) {
+        const scent_layer *const layer = layer_at( z );
+        if( layer == nullptr || z == levz ) {
+            continue;
+        }
+        jsout.start_object();
+        jsout.member( "z", z );
+        jsout.member( "scent", serialize_layer( layer ) );
+        jsout.end_object();
+    }
+    jsout.end_array();
+}
+
 static void chkversion( std::istream &fin )
 {
     if( fin.peek() == '#' ) {
@@ -201,6 +225,9 @@ void game::unserialize( std::istream &fin )
         if( data.read( "grscent", linebuf ) && data.read( "typescent", linebuff ) ) {
             scent.deserialize( linebuf );
             scent.deserialize( linebuff, true );
+            if( data.has_array( "scent_layers" ) ) {
+                scent.deserialize_layers( data.get_array( "scent_layers" ) );
+            }
         } else {
             scent.reset();
         }
@@ -242,22 +269,44 @@ void game::unserialize( std::istream &fin )
 
 void scent_map::deserialize( const std::string &data, bool is_type )
 {
-    std::istringstream buffer( data );
     if( is_type ) {
+        std::istringstream buffer( data );
         std::string str;
         buffer >> str;
         typescent = scenttype_id( str );
     } else {
-        int stmp = 0;
-        int count = 0;
-        for( auto &elem : grscent ) {
-            for( auto &val : elem ) {
-                if( count == 0 ) {
-                    buffer >> stmp >> count;
-                }
-                count--;
-                val = stmp;
+        for( std::unique_ptr<scent_layer> &layer : layers ) {
+            layer.reset();
+        }
+        decay_offset = 0;
+        deserialize_layer( data, gm.get_levz() );
+    }
+}
+
+void scent_map::deserialize_layer( const std::string &data, const int z )
+{
+    std::istringstream buffer( data );
+    scent_layer &layer = get_or_create_layer( z );
+    int stmp = 0;
+    int count = 0;
+    for( auto &elem : layer.values ) {
+        for( auto &val : elem ) {
+            if( count == 0 ) {
+                buffer >> stmp >> count;
             }
+            count--;
+            val = stmp + decay_offset;
+            layer.max_value = std::max( layer.max_value, val );
+        }
+    }
+}
+
+void scent_map::deserialize_layers( const JsonArray &ja )
+{
+    for( JsonObject jo : ja ) {
+        const int z = jo.get_int( "z" );
+        if( z >= -OVERMAP_DEPTH && z <= OVERMAP_HEIGHT ) {
+            deserialize_layer( jo.get_string( "scent" ), z );
         }
     }
 }
@@ -0,0 +1,157 @@
+#include "submap.h"
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "binary_io.h"
+#include "calendar.h"
+#include "field.h"
+#include "field_type.h"
+#include "json.h"
+#include "mapdata.h"
+#include "trap.h"
+
+namespace
+{
+
+// Each layer is stored as runs of equal values in the same order as the JSON uses: row by row.
+template<typename T, typename Write>
+void write_runs( binary_out &out, const T( &layer )[SEEX][SEEY], Write write_value )
+{
+    const T *last = nullptr;
+    uint64_t run = 0;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            const T &value = layer[i][j];
+            if( last != nullptr && value == *last ) {
+                run++;
+                continue;
+            }
+            if( last != nullptr ) {
+                write_value( *last );
+                out.write_varint( run );
+            }
+            last = &value;
+            run = 1;
+        }
+    }
+    write_value( *last );
+    out.write_varint( run );
+}
+
+template<typename T, typename Read>
+void read_runs( binary_in &in, T( &layer )[SEEX][SEEY], Read read_value )
+{
+    int tile = 0;
+    while( tile < SEEX * SEEY ) {
+        const T value = read_value();
+        const uint64_t run = in.read_varint();
+        if( run == 0 || run > static_cast<uint64_t>( SEEX * SEEY - tile ) ) {
+            throw std::runtime_error( "binary submap data has an invalid run length" );
+        }
+        for( uint64_t n = 0; n < run; n++, tile++ ) {
+            layer[tile % SEEX][tile / SEEX] = value;
+        }
+    }
+}
+
+} // namespace
+
+void submap::store_binary( binary_out &out ) const
+{
+    out.write_int( to_turn<int>( last_touched ) );
+    out.write_int( temperature );
+
+    write_runs( out, ter, [&out]( const ter_id & id ) {
+        out.write_id( id.id().str() );
+    } );
+    write_runs( out, frn, [&out]( const furn_id & id ) {
+        out.write_id( id.id().str() );
+    } );
+    write_runs( out, trp, [&out]( const trap_id & id ) {
+        out.write_id( id.id().str() );
+    } );
+    write_runs( out, rad, [&out]( const int value ) {
+        out.write_int( value );
+    } );
+
+    int field_tiles = 0;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( fld[i][j].field_count() > 0 ) {
+                field_tiles++;
+            }
+        }
+    }
+    out.write_varint( field_tiles );
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( fld[i][j].field_count() == 0 ) {
+                continue;
+            }
+            out.write_varint( j * SEEX + i );
+            out.write_varint( fld[i][j].field_count() );
+            for( const auto &elem : fld[i][j] ) {
+                const field_entry &cur = elem.second;
+                out.write_id( cur.get_field_type().id().str() );
+                out.write_int( cur.get_field_intensity() );
+                out.write_int( to_turns<int>( cur.get_field_age() + dormant_field_age( { i, j } ) ) );
+            }
+        }
+    }
+
+    std::ostringstream objects;
+    JsonOut jsout( objects );
+    jsout.start_object();
+    store_objects( jsout );
+    jsout.end_object();
+    out.write_string( objects.str() );
+}
+
+void submap::load_binary( binary_in &in, const int version )
+{
+    last_touched = time_point::from_turn( in.read_int() );
+    temperature = in.read_int();
+
+    read_runs( in, ter, [&in]() {
+        return ter_str_id( in.read_id() ).id();
+    } );
+    read_runs( in, frn, [&in]() {
+        return furn_str_id( in.read_id() ).id();
+    } );
+    read_runs( in, trp, [&in]() {
+        return trap_str_id( in.read_id() ).id();
+    } );
+    read_runs( in, rad, [&in]() {
+        return in.read_int();
+    } );
+
+    const uint64_t field_tiles = in.read_varint();
+    for( uint64_t n = 0; n < field_tiles; n++ ) {
+        const uint64_t tile = in.read_varint();
+        if( tile >= static_cast<uint64_t>( SEEX * SEEY ) ) {
+            throw std::runtime_error( "binary submap data has fields outside of the submap" );
+        }
+        field &tile_fields = fld[tile % SEEX][tile / SEEX];
+        const uint64_t count = in.read_varint();
+        for( uint64_t k = 0; k < count; k++ ) {
+            const field_type_id ft( in.read_id() );
+            const int intensity = in.read_int();
+            const int age = in.read_int();
+            if( tile_fields.find_field( ft ) == nullptr ) {
+                field_count++;
+            }
+            tile_fields.add_field( ft, intensity, time_duration::from_turns( age ) );
+        }
+    }
+
+    const std::string objects = in.read_string();
+    JsonIn jsin( objects );
+    jsin.start_object();
+    while( !jsin.end_object() ) {
+        const std::string member_name = jsin.get_member_name();
+        load( jsin, member_name, version );
+    }
+}
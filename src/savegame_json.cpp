@@ -3680,20 +3680,6 @@ void submap::store( JsonOut &jsout ) const
     }
     jsout.end_array();
 
-    jsout.member( "items" );
-    jsout.start_array();
-    for( int j = 0; j < SEEY; j++ ) {
-        for( int i = 0; i < SEEX; i++ ) {
-            if( itm[i][j].empty() ) {
-                continue;
-            }
-            jsout.write( i );
-            jsout.write( j );
-            jsout.write( itm[i][j] );
-        }
-    }
-    jsout.end_array();
-
     jsout.member( "traps" );
     jsout.start_array();
     for( int j = 0; j < SEEY; j++ ) {
@@ -3725,7 +3711,7 @@ void submap::store( JsonOut &jsout ) const
                     const field_entry &cur = elem.second;
                     jsout.write( cur.get_field_type().id() );
                     jsout.write( cur.get_field_intensity() );
-                    jsout.write( cur.get_field_age() );
+                    jsout.write( cur.get_field_age() + dormant_field_age( { i, j } ) );
                 }
                 jsout.end_array();
             }
@@ -3733,6 +3719,25 @@ void submap::store( JsonOut &jsout ) const
     }
     jsout.end_array();
 
+    store_objects( jsout );
+}
+
+void submap::store_objects( JsonOut &jsout ) const
+{
+    jsout.member( "items" );
+    jsout.start_array();
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            if( itm[i][j].empty() ) {
+                continue;
+            }
+            jsout.write( i );
+            jsout.write( j );
+            jsout.write( itm[i][j] );
+        }
+    }
+    jsout.end_array();
+
     // Write out as array of arrays of single entries
     jsout.member( "cosmetics" );
     jsout.start_array();
@@ -3888,7 +3893,7 @@ void submap::load( JsonIn &jsin, const std::string &member_name, int version )
             int rad_num = jsin.get_int();
             for( int i = 0; i < rad_num; ++i ) {
                 if( rad_cell < SEEX * SEEY ) {
-                    set_radiation( { 0 % SEEX, rad_cell / SEEX }, rad_strength );
+                    set_radiation( { rad_cell % SEEX, rad_cell / SEEX }, rad_strength );
                     rad_cell++;
                 }
             }
@@ -1,8 +1,10 @@
 #include "scent_map.h"
 
+#include <climits>
 #include <cstdlib>
 #include <cassert>
 #include <algorithm>
+#include <memory>
 
 #include "assign.h"
 #include "calendar.h"
@@ -10,10 +12,13 @@
 #include "game.h"
 #include "generic_factory.h"
 #include "map.h"
+#include "mapdata.h"
 #include "output.h"
 #include "cursesdef.h"
 
 static constexpr int SCENT_RADIUS = 40;
+// Each turn, a tenth of the difference in scent between two levels evens out.
+static constexpr int VERTICAL_SHARE = 10;
 
 static nc_color sev( const size_t level )
 {
@@ -47,23 +52,56 @@ static nc_color sev( const size_t level )
 
 void scent_map::reset()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = 0;
-        }
+    for( std::unique_ptr<scent_layer> &layer : layers ) {
+        layer.reset();
     }
+    decay_offset = 0;
     typescent = scenttype_id();
 }
 
+scent_map::scent_layer &scent_map::get_or_create_layer( const int z )
+{
+    std::unique_ptr<scent_layer> &layer = layers[z + OVERMAP_DEPTH];
+    if( !layer ) {
+        layer = std::make_unique<scent_layer>();
+        for( auto &elem : layer->values ) {
+            elem.fill( 0 );
+        }
+    }
+    return *layer;
+}
+
 void scent_map::decay()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = std::max( 0, val - 1 );
+    decay_offset++;
+    // Keep the stored values far away from overflowing. This happens once in a few
+    // hundred thousand years of game time, so it does not matter that it is a full pass.
+    if( decay_offset >= INT_MAX / 2 ) {
+        apply_decay();
+    }
+    for( std::unique_ptr<scent_layer> &layer : layers ) {
+        if( layer && layer->max_value <= decay_offset ) {
+            layer.reset();
         }
     }
 }
 
+void scent_map::apply_decay()
+{
+    for( std::unique_ptr<scent_layer> &layer : layers ) {
+        if( !layer ) {
+            continue;
+        }
+        for( auto &elem : layer->values ) {
+            for( auto &val : elem ) {
+                val = std::max( 0, val - decay_offset );
+            }
+        }
+        layer->max_value = std::max( 0, layer->max_value - decay_offset );
+    }
+    decay_offset = 0;
+}
+
 void scent_map::draw( const catacurses::window &win, const int div, const tripoint &center ) const
 {
     assert( div != 0 );
@@ -79,19 +117,24 @@ void scent_map::draw( const catacurses::window &win, const int div, const tripoi
 
 void scent_map::shift( const int sm_shift_x, const int sm_shift_y )
 {
-    scent_array<int> new_scent;
-    for( size_t x = 0; x < MAPSIZE_X; ++x ) {
-        for( size_t y = 0; y < MAPSIZE_Y; ++y ) {
-            const point p( x + sm_shift_x, y + sm_shift_y );
-            new_scent[x][y] = inbounds( p ) ? grscent[ p.x ][ p.y ] : 0;
+    for( std::unique_ptr<scent_layer> &layer : layers ) {
+        if( !layer ) {
+            continue;
+        }
+        scent_array<int> new_scent;
+        for( size_t x = 0; x < MAPSIZE_X; ++x ) {
+            for( size_t y = 0; y < MAPSIZE_Y; ++y ) {
+                const point p( x + sm_shift_x, y + sm_shift_y );
+                new_scent[x][y] = inbounds( p ) ? layer->values[ p.x ][ p.y ] : 0;
+            }
         }
+        layer->values = new_scent;
     }
-    grscent = new_scent;
 }
 
 int scent_map::get( const tripoint &p ) const
 {
-    if( inbounds( p ) && grscent[p.x][p.y] > 0 ) {
+    if( inbounds( p ) ) {
         return get_unsafe( p );
     }
     return 0;
@@ -106,20 +149,22 @@ void scent_map::set( const tripoint &p, int value, const scenttype_id &type )
 
 void scent_map::set_unsafe( const tripoint &p, int value, const scenttype_id &type )
 {
-    grscent[p.x][p.y] = value;
+    scent_layer &layer = get_or_create_layer( p.z );
+    layer.values[p.x][p.y] = value + decay_offset;
+    layer.max_value = std::max( layer.max_value, value + decay_offset );
     if( !type.is_empty() ) {
         typescent = type;
     }
 }
 int scent_map::get_unsafe( const tripoint &p ) const
 {
-    return grscent[p.x][p.y] - std::abs( gm.get_levz() - p.z );
+    return value_at( p );
 }
 
 scenttype_id scent_map::get_type( const tripoint &p ) const
 {
     scenttype_id id;
-    if( inbounds( p ) && grscent[p.x][p.y] > 0 ) {
+    if( inbounds( p ) && value_at( p ) > 0 ) {
         id = typescent;
     }
     return id;
@@ -127,23 +172,18 @@ scenttype_id scent_map::get_type( const tripoint &p ) const
 
 bool scent_map::inbounds( const tripoint &p ) const
 {
-    // HACK: This weird long check here is a hack around the fact that scentmap is 2D
-    // A z-level can access scentmap if it is within SCENT_MAP_Z_REACH flying z-level move from player's z-level
-    // That is, if a flying critter could move directly up or down (or stand still) and be on same z-level as player
-    const int levz = gm.get_levz();
-    const bool scent_map_z_level_inbounds = ( p.z == levz ) ||
-                                            ( std::abs( p.z - levz ) == SCENT_MAP_Z_REACH &&
-                                                    gm.m.valid_move( p, tripoint( p.xy(), levz ), false, true ) );
-    if( !scent_map_z_level_inbounds ) {
-        return false;
-    }
+    return p.z >= -OVERMAP_DEPTH && p.z <= OVERMAP_HEIGHT && inbounds( p.xy() );
+}
+
+bool scent_map::inbounds( const point &p ) const
+{
     static constexpr point scent_map_boundary_min( point_zero );
     static constexpr point scent_map_boundary_max( MAPSIZE_X, MAPSIZE_Y );
 
     static constexpr rectangle scent_map_boundaries(
         scent_map_boundary_min, scent_map_boundary_max );
 
-    return scent_map_boundaries.contains_half_open( p.xy() );
+    return scent_map_boundaries.contains_half_open( p );
 }
 
 void scent_map::update( const tripoint &center, map &m )
@@ -157,11 +197,28 @@ void scent_map::update( const tripoint &center, map &m )
         return;
     }
 
-    // note: the next four intermediate matrices need to be at least
+    // Without z-levels only the current level is loaded.
+    const int minz = m.has_zlevels() ? -OVERMAP_DEPTH : center.z;
+    const int maxz = m.has_zlevels() ? OVERMAP_HEIGHT : center.z;
+    for( int z = minz; z <= maxz; ++z ) {
+        if( scent_layer *const layer = layer_at( z ) ) {
+            diffuse( *layer, center.xy(), z, m );
+        }
+    }
+    for( int z = minz; z < maxz; ++z ) {
+        if( layer_at( z ) != nullptr || layer_at( z + 1 ) != nullptr ) {
+            diffuse_vertically( center.xy(), z, m );
+        }
+    }
+}
+
+void scent_map::diffuse( scent_layer &layer, const point &center, const int z, map &m )
+{
+    // note: the intermediate matrices need to be at least
     // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
     // The code I'm modifying used [MAPSIZE_X]. I'm staying with that to avoid new bugs.
 
-    // These two matrices are transposed so that x addresses are contiguous in memory
+    // Sums of the weighted scent and of the weights of 3 neighboring squares in the y direction
     scent_array<int> sum_3_scent_y;
     scent_array<int> squares_used_y;
 
@@ -169,6 +226,8 @@ void scent_map::update( const tripoint &center, map &m )
     scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
     scent_array<bool> reduces_scent;
 
+    scent_array<int> &values = layer.values;
+
     // for loop constants
     const int scentmap_minx = center.x - SCENT_RADIUS;
     const int scentmap_maxx = center.x + SCENT_RADIUS;
@@ -181,7 +240,21 @@ void scent_map::update( const tripoint &center, map &m )
 
     // The new scent flag searching function. Should be wayyy faster than the old one.
     m.scent_blockers( blocks_scent, reduces_scent, point( scentmap_minx - 1, scentmap_miny - 1 ),
-                      point( scentmap_maxx + 1, scentmap_maxy + 1 ) );
+                      point( scentmap_maxx + 1, scentmap_maxy + 1 ), z );
+
+    // The loops below have no branches, so the compiler can vectorize the inner loops,
+    // which run along y where the arrays are contiguous. Instead of checking the flags,
+    // each square gets weights that are 0 for squares that block scent:
+    // 10 for squares that let scent pass, only 2 (20%) on REDUCE_SCENT squares.
+    const auto weight = [&]( const int x, const int y ) {
+        return !blocks_scent[x][y] * ( 10 - 8 * reduces_scent[x][y] );
+    };
+    // Scent with the pending decay applied.
+    const int offset = decay_offset;
+    const auto scent_at = [&]( const int x, const int y ) {
+        return std::max( 0, values[x][y] - offset );
+    };
+
     // Sum neighbors in the y direction.  This way, each square gets called 3 times instead of 9
     // times. This cost us an extra loop here, but it also eliminated a loop at the end, so there
     // is a net performance improvement over the old code. Could probably still be better.
@@ -190,60 +263,112 @@ void scent_map::update( const tripoint &center, map &m )
     // MAPSIZE_X, but if that changes, this may need tweaking.
     for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
         for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
+            const int w_below = weight( x, y - 1 );
+            const int w_here = weight( x, y );
+            const int w_above = weight( x, y + 1 );
             // remember the sum of the scent val for the 3 neighboring squares that can defuse into
-            sum_3_scent_y[y][x] = 0;
-            squares_used_y[y][x] = 0;
-            for( int i = y - 1; i <= y + 1; ++i ) {
-                if( !blocks_scent[x][i] ) {
-                    if( reduces_scent[x][i] ) {
-                        // only 20% of scent can diffuse on REDUCE_SCENT squares
-                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
-                        squares_used_y[y][x] += 2;
-                    } else {
-                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
-                        squares_used_y[y][x] += 10;
-                    }
-                }
-            }
+            sum_3_scent_y[x][y] = w_below * scent_at( x, y - 1 ) + w_here * scent_at( x, y ) +
+                                  w_above * scent_at( x, y + 1 );
+            squares_used_y[x][y] = w_below + w_here + w_above;
         }
     }
 
     // Rest of the scent map
     for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
         for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            int &scent_here = grscent[x][y];
-            if( !blocks_scent[x][y] ) {
-                // to how many neighboring squares do we diffuse out? (include our own square
-                // since we also include our own square when diffusing in)
-                const int squares_used = squares_used_y[y][x - 1]
-                                         + squares_used_y[y][x]
-                                         + squares_used_y[y][x + 1];
-
-                int this_diffusivity;
-                if( !reduces_scent[x][y] ) {
-                    this_diffusivity = diffusivity;
-                } else {
-                    this_diffusivity = diffusivity / 5; //less air movement for REDUCE_SCENT square
-                }
-                // take the old scent and subtract what diffuses out
-                int temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
-                // neighboring walls and reduce_scent squares absorb some scent
-                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
-                // we've already summed neighboring scent values in the y direction in the previous
-                // loop. Now we do it for the x direction, multiply by diffusion, and this is what
-                // diffuses into our current square.
-                scent_here =
-                    ( temp_scent
-                      + this_diffusivity * ( sum_3_scent_y[y][x - 1]
-                                             + sum_3_scent_y[y][x]
-                                             + sum_3_scent_y[y][x + 1] )
-                    ) / ( 1000 * 10 );
-            } else {
-                // this cell blocks scent
-                scent_here = 0;
+            const int scent_here = scent_at( x, y );
+            const int passes = !blocks_scent[x][y];
+            // to how many neighboring squares do we diffuse out? (include our own square
+            // since we also include our own square when diffusing in)
+            const int squares_used = squares_used_y[x - 1][y]
+                                     + squares_used_y[x][y]
+                                     + squares_used_y[x + 1][y];
+            // less air movement for REDUCE_SCENT square, none at all for blocking ones
+            const int this_diffusivity = passes * ( diffusivity - diffusivity * 4 / 5 *
+                                                    reduces_scent[x][y] );
+            // take the old scent and subtract what diffuses out
+            int temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+            // neighboring walls and reduce_scent squares absorb some scent
+            temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+            // we've already summed neighboring scent values in the y direction in the previous
+            // loop. Now we do it for the x direction, multiply by diffusion, and this is what
+            // diffuses into our current square.
+            const int new_scent =
+                ( temp_scent
+                  + this_diffusivity * ( sum_3_scent_y[x - 1][y]
+                                         + sum_3_scent_y[x][y]
+                                         + sum_3_scent_y[x + 1][y] )
+                ) / ( 1000 * 10 );
+            // squares that block scent have none
+            values[x][y] = passes * new_scent + offset;
+        }
+    }
+}
+
+void scent_map::diffuse_vertically( const point &center, const int z, map &m )
+{
+    const int minx = center.x - SCENT_RADIUS;
+    const int maxx = center.x + SCENT_RADIUS;
+    const int miny = center.y - SCENT_RADIUS;
+    const int maxy = center.y + SCENT_RADIUS;
+
+    const int offset = decay_offset;
+    scent_layer *below = layer_at( z );
+    scent_layer *above = layer_at( z + 1 );
+    const auto scent_at = [offset]( const scent_layer * layer, const int x, const int y ) {
+        return layer != nullptr ? std::max( 0, layer->values[x][y] - offset ) : 0;
+    };
+
+    // Scent only moves where the levels differ enough for a share of it to be whole.
+    // Finding those tiles needs no map lookups, most turns it stops here.
+    scent_array<bool> open;
+    bool any_open = false;
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            open[x][y] = std::abs( scent_at( below, x, y ) - scent_at( above, x, y ) ) >= VERTICAL_SHARE;
+            any_open |= open[x][y];
+        }
+    }
+    if( !any_open ) {
+        return;
+    }
+
+    // Of those, the ones where scent can pass between the levels: holes in the floor
+    // above and stairs up.
+    m.build_floor_cache( z + 1 );
+    const auto &floor_above = m.get_cache_ref( z + 1 ).floor_cache;
+    any_open = false;
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            if( open[x][y] ) {
+                open[x][y] = !floor_above[x][y] || m.has_flag_ter( TFLAG_GOES_UP, tripoint( x, y, z ) );
+                any_open |= open[x][y];
             }
         }
     }
+    if( !any_open ) {
+        return;
+    }
+    // Some scent crosses, so the level without scent gets a layer now.
+    below = &get_or_create_layer( z );
+    above = &get_or_create_layer( z + 1 );
+
+    // Like the diffusion on a level, this has no branches, so it can be vectorized.
+    scent_array<int> &values_below = below->values;
+    scent_array<int> &values_above = above->values;
+    for( int x = minx; x <= maxx; ++x ) {
+        for( int y = miny; y <= maxy; ++y ) {
+            const int scent_below = std::max( 0, values_below[x][y] - offset );
+            const int scent_above = std::max( 0, values_above[x][y] - offset );
+            const int flow = open[x][y] * ( scent_below - scent_above ) / VERTICAL_SHARE;
+            values_below[x][y] = scent_below - flow + offset;
+            values_above[x][y] = scent_above + flow + offset;
+        }
+    }
+    // The exchange only averages the values.
+    const int max_value = std::max( below->max_value, above->max_value );
+    below->max_value = max_value;
+    above->max_value = max_value;
 }
 
 namespace
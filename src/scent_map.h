@@ -2,7 +2,9 @@
 #ifndef SCENT_H
 #define SCENT_H
 
+#include <algorithm>
 #include <array>
+#include <memory>
 #include <string>
 
 #include "calendar.h"
@@ -16,6 +18,8 @@ static constexpr int SCENT_MAP_Z_REACH = 1;
 
 class map;
 class game;
+class JsonArray;
+class JsonOut;
 
 namespace catacurses
 {
@@ -42,23 +46,79 @@ class scent_map
         template<typename T>
         using scent_array = std::array<std::array<T, MAPSIZE_Y>, MAPSIZE_X>;
 
-        scent_array<int> grscent;
+        /** Scent of one z-level. */
+        struct scent_layer {
+            /**
+             * Scent values plus @ref decay_offset as it was when they were set. The actual
+             * scent is `std::max( 0, values[x][y] - decay_offset )`, see @ref decay.
+             */
+            scent_array<int> values;
+            /**
+             * No value is bigger than this. Diffusion only averages values, so this only
+             * grows when scent is set. Once the decay reaches it, the layer is released.
+             */
+            int max_value = 0;
+        };
+
+        /**
+         * Layers for all z-levels, indexed by `z + OVERMAP_DEPTH`. They are allocated when
+         * scent is set on or spreads into a level, so only levels with scent take memory.
+         */
+        std::array<std::unique_ptr<scent_layer>, OVERMAP_LAYERS> layers;
+        /** How often @ref decay has run since the values were last brought to their actual value. */
+        int decay_offset = 0;
         scenttype_id typescent;
         cata::optional<tripoint> player_last_position;
         time_point player_last_moved = calendar::before_time_starts;
 
         const game &gm;
 
+        /** The layer of z-level @p z, or null if it has no scent. */
+        scent_layer *layer_at( int z ) const {
+            return z >= -OVERMAP_DEPTH && z <= OVERMAP_HEIGHT ? layers[z + OVERMAP_DEPTH].get() : nullptr;
+        }
+        /** The layer of z-level @p z, it is allocated (without scent) if needed. */
+        scent_layer &get_or_create_layer( int z );
+        /** Actual scent value of the tile. */
+        int value_at( const tripoint &p ) const {
+            const scent_layer *const layer = layer_at( p.z );
+            return layer != nullptr ? std::max( 0, layer->values[p.x][p.y] - decay_offset ) : 0;
+        }
+        /** Applies the pending decay to all values and resets @ref decay_offset. */
+        void apply_decay();
+        /** Spreads the scent of @p layer around @p center on z-level @p z. */
+        void diffuse( scent_layer &layer, const point &center, int z, map &m );
+        /**
+         * Exchanges scent between z-levels @p z and `z + 1` around
+         * @p center, where the upper level has no floor or stairs lead up.
+         */
+        void diffuse_vertically( const point &center, int z, map &m );
+
+        std::string serialize_layer( const scent_layer *layer ) const;
+        void deserialize_layer( const std::string &data, int z );
+
     public:
         scent_map( const game &g ) : gm( g ) { }
 
+        /**
+         * The scent of the player's z-level in the old format, or the scent type.
+         * The other z-levels are stored by @ref serialize_layers.
+         */
+        /**@{*/
         void deserialize( const std::string &data, bool is_type = false );
         std::string serialize( bool is_type = false ) const;
+        /**@}*/
+        void deserialize_layers( const JsonArray &ja );
+        void serialize_layers( JsonOut &jsout ) const;
 
         void draw( const catacurses::window &win, int div, const tripoint &center ) const;
 
         void update( const tripoint &center, map &m );
         void reset();
+        /**
+         * Reduces all scent values by one. This does not touch the values, it only counts
+         * up @ref decay_offset, which is subtracted when they are read.
+         */
         void decay();
         void shift( int sm_shift_x, int sm_shift_y );
 
@@ -77,9 +137,7 @@ class scent_map
         scenttype_id get_type( const tripoint &p ) const;
 
         bool inbounds( const tripoint &p ) const;
-        bool inbounds( const point &p ) const {
-            return inbounds( tripoint( p, 0 ) );
-        }
+        bool inbounds( const point &p ) const;
 };
 
 #endif
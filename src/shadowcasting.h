@@ -24,7 +24,8 @@ enum class quadrant {
     default_ = NE
 };
 
-struct four_quadrants {
+// Aligned so the four values of a tile never straddle a cache line and load as one vector.
+struct alignas( 16 ) four_quadrants {
     four_quadrants() = default;
     explicit constexpr four_quadrants( float v ) : values{{v, v, v, v}} {}
 
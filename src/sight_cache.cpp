@@ -0,0 +1,55 @@
+#include "sight_cache.h"
+
+#include "creature.h"
+
+void sight_cache::start()
+{
+    entries.clear();
+    active = true;
+}
+
+void sight_cache::stop()
+{
+    entries.clear();
+    active = false;
+}
+
+void sight_cache::invalidate()
+{
+    entries.clear();
+}
+
+void sight_cache::forget( const Creature &critter )
+{
+    if( entries.empty() ) {
+        return;
+    }
+    for( auto iter = entries.begin(); iter != entries.end(); ) {
+        if( iter->first.first == &critter || iter->first.second == &critter ) {
+            iter = entries.erase( iter );
+        } else {
+            ++iter;
+        }
+    }
+}
+
+cata::optional<bool> sight_cache::find( const Creature &observer, const Creature &target ) const
+{
+    if( !active ) {
+        return cata::nullopt;
+    }
+    const auto iter = entries.find( std::make_pair( &observer, &target ) );
+    if( iter == entries.end() || iter->second.observer_pos != observer.pos() ||
+        iter->second.target_pos != target.pos() ) {
+        return cata::nullopt;
+    }
+    return iter->second.seen;
+}
+
+void sight_cache::store( const Creature &observer, const Creature &target, const bool seen )
+{
+    if( !active ) {
+        return;
+    }
+    entries[std::make_pair( &observer, &target )] = entry{ observer.pos(), target.pos(), seen };
+}
@@ -0,0 +1,59 @@
+#pragma once
+#ifndef SIGHT_CACHE_H
+#define SIGHT_CACHE_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+
+#include "hash_utils.h"
+#include "optional.h"
+#include "point.h"
+
+class Creature;
+
+/**
+ * Remembers which creatures see which other creatures (@ref Creature::sees) while the
+ * monsters and NPCs act in @ref game::monmove.
+ *
+ * The AI of monsters and NPCs asks for the same pairs many times per turn, and each check
+ * needs the line of sight, lighting and the cover between them. A result stays valid while
+ * both creatures stay where they were and keep their effects and bionics (see @ref forget),
+ * until the transparency of the map changes and @ref invalidate is called. The cache only lives between @ref start and @ref stop, which
+ * game::monmove calls, so everything else (safe mode, drawing, special attacks during the
+ * player's turn) always asks for a fresh answer.
+ */
+class sight_cache
+{
+    public:
+        /** Starts remembering results, after everything the player did this turn. */
+        void start();
+        /** Forgets all results and stops remembering them. */
+        void stop();
+        /** Forgets all results. */
+        void invalidate();
+        /**
+         * Forgets the results with @p critter as observer or target, because something that
+         * decides about seeing changed (effects like blindness or invisibility, bionics).
+         */
+        void forget( const Creature &critter );
+
+        /**
+         * The remembered result of @p observer seeing @p target, if it is still valid.
+         * Always empty outside of @ref start and @ref stop.
+         */
+        cata::optional<bool> find( const Creature &observer, const Creature &target ) const;
+        void store( const Creature &observer, const Creature &target, bool seen );
+
+    private:
+        struct entry {
+            tripoint observer_pos;
+            tripoint target_pos;
+            bool seen;
+        };
+        std::unordered_map<std::pair<const Creature *, const Creature *>, entry, cata::tuple_hash>
+        entries;
+        bool active = false;
+};
+
+#endif // SIGHT_CACHE_H
@@ -12,6 +12,7 @@
 
 #include "avatar.h"
 #include "coordinate_conversions.h"
+#include "creature_tracker.h"
 #include "debug.h"
 #include "effect.h"
 #include "enums.h"
@@ -286,12 +287,12 @@ void sounds::process_sounds()
             overmap_buffer.signal_hordes( target, sig_power );
         }
         // Alert all monsters (that can hear) to the sound.
-        for( monster &critter : g->all_monsters() ) {
+        // Exclude monsters that certainly won't hear the sound
+        for( monster *const critter : g->critter_tracker->creatures_in_radius( source, vol * 2 - 1 ) ) {
             // TODO: Generalize this to Creature::hear_sound
-            const int dist = rl_dist( source, critter.pos() );
+            const int dist = rl_dist( source, critter->pos() );
             if( vol * 2 > dist ) {
-                // Exclude monsters that certainly won't hear the sound
-                critter.hear_sound( source, vol, dist );
+                critter->hear_sound( source, vol, dist );
             }
         }
     }
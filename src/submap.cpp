@@ -1,6 +1,7 @@
 #include "submap.h"
 
 #include <algorithm>
+#include <climits>
 #include <memory>
 #include <iterator>
 #include <array>
@@ -237,6 +238,16 @@ void submap::rotate( int turns )
         return p.rotate( turns, { SEEX, SEEY } );
     };
 
+    // The field index is about the old tile positions, start over with all fields awake.
+    if( fields_activity ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            for( int j = 0; j < SEEY; j++ ) {
+                wake_fields( { i, j } );
+            }
+        }
+        fields_activity.reset();
+    }
+
     if( turns == 2 ) {
         // Swap horizontal stripes.
         for( int j = 0, je = SEEY / 2; j < je; ++j ) {
@@ -296,3 +307,104 @@ void submap::rotate( int turns )
     }
     computers = rot_comp;
 }
+
+static bool wakes_later( const field_activity::wakeup &lhs, const field_activity::wakeup &rhs )
+{
+    return lhs.turn > rhs.turn;
+}
+
+void submap::start_field_processing()
+{
+    if( !fields_activity ) {
+        // Nothing is known about the fields yet (e.g. the submap was just loaded), look at all of them.
+        fields_activity = std::make_unique<field_activity>();
+        for( int i = 0; i < SEEX; i++ ) {
+            for( int j = 0; j < SEEY; j++ ) {
+                if( fld[i][j].field_count() > 0 ) {
+                    fields_activity->active.set( i * SEEY + j );
+                }
+            }
+        }
+    }
+    field_activity &activity = *fields_activity;
+    activity.turns++;
+    activity.scan_pos = 0;
+    std::vector<field_activity::wakeup> &wakeups = activity.wakeups;
+    while( !wakeups.empty() && wakeups.front().turn <= activity.turns ) {
+        const field_activity::wakeup due = wakeups.front();
+        std::pop_heap( wakeups.begin(), wakeups.end(), wakes_later );
+        wakeups.pop_back();
+        if( activity.dormant[due.tile] && activity.dormant_since[due.tile] == due.since ) {
+            wake_fields( { due.tile / SEEY, due.tile % SEEY } );
+        }
+    }
+}
+
+bool submap::field_processing_due( const point &p )
+{
+    const int tile = p.x * SEEY + p.y;
+    fields_activity->scan_pos = tile;
+    return fields_activity->active[tile];
+}
+
+void submap::finish_field_processing( const point &p, const int dormant_turns )
+{
+    field_activity &activity = *fields_activity;
+    const int tile = p.x * SEEY + p.y;
+    activity.scan_pos = tile + 1;
+    if( fld[p.x][p.y].field_count() == 0 ) {
+        activity.active.reset( tile );
+        return;
+    }
+    if( dormant_turns <= 0 ) {
+        return;
+    }
+    activity.active.reset( tile );
+    activity.dormant.set( tile );
+    activity.dormant_since[tile] = activity.turns;
+    if( dormant_turns >= INT_MAX - activity.turns - 1 ) {
+        return;
+    }
+    std::vector<field_activity::wakeup> &wakeups = activity.wakeups;
+    if( wakeups.size() >= 2 * field_activity::tiles ) {
+        // Tiles that keep getting woken up early would pile up stale wakeups.
+        wakeups.erase( std::remove_if( wakeups.begin(), wakeups.end(),
+        [&activity]( const field_activity::wakeup & w ) {
+            return !activity.dormant[w.tile] || activity.dormant_since[w.tile] != w.since;
+        } ), wakeups.end() );
+        std::make_heap( wakeups.begin(), wakeups.end(), wakes_later );
+    }
+    wakeups.push_back( { activity.turns + dormant_turns + 1, activity.turns, tile } );
+    std::push_heap( wakeups.begin(), wakeups.end(), wakes_later );
+}
+
+void submap::end_field_processing()
+{
+    fields_activity->scan_pos = field_activity::tiles;
+}
+
+void submap::wake_fields( const point &p )
+{
+    const int tile = p.x * SEEY + p.y;
+    if( !fields_activity || !fields_activity->dormant[tile] ) {
+        return;
+    }
+    const time_duration missed = dormant_field_age( p );
+    fields_activity->dormant.reset( tile );
+    fields_activity->active.set( tile );
+    for( auto &fp : fld[p.x][p.y] ) {
+        fp.second.mod_field_age( missed );
+    }
+}
+
+time_duration submap::dormant_field_age( const point &p ) const
+{
+    const int tile = p.x * SEEY + p.y;
+    if( !fields_activity || !fields_activity->dormant[tile] ) {
+        return 0_turns;
+    }
+    // Tiles the scan has not reached yet get processed later in the current turn.
+    const int missed = fields_activity->turns - fields_activity->dormant_since[tile] -
+                       ( tile >= fields_activity->scan_pos ? 1 : 0 );
+    return time_duration::from_turns( missed );
+}
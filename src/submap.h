@@ -2,6 +2,8 @@
 #ifndef SUBMAP_H
 #define SUBMAP_H
 
+#include <array>
+#include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -23,6 +25,8 @@
 
 class JsonIn;
 class JsonOut;
+class binary_in;
+class binary_out;
 class basecamp;
 class map;
 struct trap;
@@ -59,6 +63,37 @@ struct maptile_soa {
     void swap_soa_tile( const point &p, maptile_soa<1, 1> &other );
 };
 
+/**
+ * Sparse index of the tiles of a submap whose fields @ref map::process_fields_in_submap
+ * has to look at.
+ * Fields that would do nothing but grow older for a while are dormant: their tile is
+ * skipped until a timer runs out or until the fields are accessed for writing, then
+ * they are aged by the turns they missed.
+ */
+struct field_activity {
+    static constexpr int tiles = SEEX * SEEY;
+
+    /** Tiles that may hold fields that are processed each turn, indexed by x * SEEY + y. */
+    std::bitset<tiles> active;
+    /** Tiles whose fields are all dormant. */
+    std::bitset<tiles> dormant;
+    /** Value of @ref turns when each dormant tile was processed the last time. */
+    std::array<int, tiles> dormant_since;
+
+    struct wakeup {
+        int turn;
+        int since;
+        int tile;
+    };
+    /** Heap with the earliest wakeup in front, entries of tiles woken up early are stale. */
+    std::vector<wakeup> wakeups;
+
+    /** Number of times the fields of the submap have been processed. */
+    int turns = 0;
+    /** The tiles before this one have already been processed in the current turn. */
+    int scan_pos = tiles;
+};
+
 class submap : maptile_soa<SEEX, SEEY>
 {
     public:
@@ -166,6 +201,14 @@ class submap : maptile_soa<SEEX, SEEY>
 
         // TODO: Replace this as it essentially makes fld public
         field &get_field( const point &p ) {
+            // The caller may add fields or change them, so they need to be processed again.
+            if( fields_activity ) {
+                const int tile = p.x * SEEY + p.y;
+                fields_activity->active.set( tile );
+                if( fields_activity->dormant[tile] ) {
+                    wake_fields( p );
+                }
+            }
             return fld[p.x][p.y];
         }
 
@@ -223,8 +266,33 @@ class submap : maptile_soa<SEEX, SEEY>
 
         void rotate( int turns );
 
+        /**
+         * Field processing, see @ref map::process_fields_in_submap.
+         * Called before the tiles are processed, wakes up the dormant tiles that are due.
+         */
+        void start_field_processing();
+        /** Whether the fields on @p p need processing, called for all tiles in index order. */
+        bool field_processing_due( const point &p );
+        /**
+         * Called once the fields on @p p have been processed. If they would do nothing but
+         * grow older during the next @p dormant_turns turns, the tile is skipped until then.
+         * INT_MAX lets them sleep until they are accessed.
+         */
+        void finish_field_processing( const point &p, int dormant_turns );
+        void end_field_processing();
+        /** Wakes up the fields on @p p if they are dormant. */
+        void wake_fields( const point &p );
+        /** The age the fields on @p p are missing because they are dormant. */
+        time_duration dormant_field_age( const point &p ) const;
+
         void store( JsonOut &jsout ) const;
         void load( JsonIn &jsin, const std::string &member_name, int version );
+        /**
+         * Same content as @ref store / @ref load in the compact binary format. Only the
+         * tile layers are encoded directly, items and other objects stay JSON inside it.
+         */
+        void store_binary( binary_out &out ) const;
+        void load_binary( binary_in &in, int version );
 
         // If is_uniform is true, this submap is a solid block of terrain
         // Uniform submaps aren't saved/loaded, because regenerating them is faster
@@ -250,8 +318,12 @@ class submap : maptile_soa<SEEX, SEEY>
         std::map<point, computer> computers;
         std::unique_ptr<computer> legacy_computer;
         int temperature = 0;
+        /** Created when the fields are processed the first time. */
+        std::unique_ptr<field_activity> fields_activity;
 
         void update_legacy_computer();
+        /** Stores the members that are not tile layers, the part shared by both formats. */
+        void store_objects( JsonOut &jsout ) const;
 
         static constexpr size_t elements = SEEX * SEEY;
 };
@@ -301,7 +373,8 @@ struct maptile {
         }
 
         const field &get_field() const {
-            return sm->get_field( pos() );
+            const submap &const_sm = *sm;
+            return const_sm.get_field( pos() );
         }
 
         field_entry *find_field( const field_type_id &field_to_find ) {
@@ -0,0 +1,144 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+#if defined(_WIN32) && !defined(_MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+namespace
+{
+
+/** Shared by the threads working on one @ref thread_pool::parallel_for call. */
+struct loop_state {
+    loop_state( const int begin, const int end, const std::function<void( int )> &task ) :
+        next( begin ), end( end ), remaining( end - begin ), task( task ) {
+    }
+
+    std::atomic<int> next;
+    const int end;
+    /** Indices that have not been finished yet. */
+    std::atomic<int> remaining;
+    std::atomic<bool> failed{ false };
+    // Only used while indices are left, so the caller is still waiting and it is still alive.
+    const std::function<void( int )> &task;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+void run_indices( loop_state &state )
+{
+    for( ;; ) {
+        const int index = state.next.fetch_add( 1 );
+        if( index >= state.end ) {
+            return;
+        }
+        if( !state.failed.load() ) {
+            try {
+                state.task( index );
+            } catch( ... ) {
+                std::lock_guard<std::mutex> lock( state.mutex );
+                if( !state.error ) {
+                    state.error = std::current_exception();
+                }
+                state.failed.store( true );
+            }
+        }
+        if( state.remaining.fetch_sub( 1 ) == 1 ) {
+            std::lock_guard<std::mutex> lock( state.mutex );
+            state.finished.notify_all();
+        }
+    }
+}
+
+} // namespace
+
+thread_pool::thread_pool( const unsigned workers_count )
+{
+    workers.reserve( workers_count );
+    for( unsigned i = 0; i < workers_count; i++ ) {
+        workers.emplace_back( [this]() {
+            work();
+        } );
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for( std::thread &worker : workers ) {
+        worker.join();
+    }
+}
+
+void thread_pool::work()
+{
+    for( ;; ) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock( mutex );
+            wakeup.wait( lock, [this]() {
+                return stopping || !queue.empty();
+            } );
+            if( queue.empty() ) {
+                return;
+            }
+            job = std::move( queue.front() );
+            queue.pop_front();
+        }
+        job();
+    }
+}
+
+void thread_pool::parallel_for( const int begin, const int end,
+                                const std::function<void( int )> &task )
+{
+    if( end <= begin ) {
+        return;
+    }
+    if( workers.empty() || end - begin == 1 ) {
+        for( int i = begin; i < end; i++ ) {
+            task( i );
+        }
+        return;
+    }
+
+    const auto state = std::make_shared<loop_state>( begin, end, task );
+    // Helpers that only get to run after the caller took the last index return immediately.
+    const size_t helpers = std::min( workers.size(), static_cast<size_t>( end - begin - 1 ) );
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        for( size_t i = 0; i < helpers; i++ ) {
+            queue.emplace_back( [state]() {
+                run_indices( *state );
+            } );
+        }
+    }
+    wakeup.notify_all();
+
+    run_indices( *state );
+    {
+        std::unique_lock<std::mutex> lock( state->mutex );
+        state->finished.wait( lock, [&state]() {
+            return state->remaining.load() == 0;
+        } );
+    }
+    if( state->error ) {
+        std::rethrow_exception( state->error );
+    }
+}
+
+thread_pool &shared_thread_pool()
+{
+    static thread_pool pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+    return pool;
+}
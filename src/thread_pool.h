@@ -0,0 +1,54 @@
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed number of worker threads that run independent pieces of work.
+ *
+ * The work handed to the pool must not touch anything another piece of work writes to,
+ * and nothing that is not thread safe (e.g. @ref debugmsg, the random number generator,
+ * the UI). The results are then the same as if everything ran serially on the calling thread.
+ */
+class thread_pool
+{
+    public:
+        /** Starts @p workers threads, with 0 everything runs on the calling thread. */
+        explicit thread_pool( unsigned workers );
+        ~thread_pool();
+        thread_pool( const thread_pool & ) = delete;
+        thread_pool &operator=( const thread_pool & ) = delete;
+
+        /**
+         * Calls @p task for every index in [begin, end) and returns once all calls are done.
+         * The calling thread takes part in the work, so this may be nested and called from
+         * inside a task. If a call throws, the remaining indices are skipped and the exception
+         * is rethrown here.
+         */
+        void parallel_for( int begin, int end, const std::function<void( int )> &task );
+
+        /** Number of worker threads, not counting the calling thread. */
+        size_t size() const {
+            return workers.size();
+        }
+
+    private:
+        void work();
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> queue;
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        bool stopping = false;
+};
+
+/** The pool shared by the game, with one worker per hardware thread except the main one. */
+thread_pool &shared_thread_pool();
+
+#endif // THREAD_POOL_H
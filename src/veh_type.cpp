@@ -489,26 +489,26 @@ void vpart_info::finalize()
             e.second.z_order = 0;
             e.second.list_order = 5;
         }
-    }
-}
-
-void vpart_info::check()
-{
-    for( auto &vp : vpart_info_all ) {
-        auto &part = vp.second;
 
         // add the base item to the installation requirements
         // TODO: support multiple/alternative base items
         requirement_data ins;
-        ins.components.push_back( { { { part.item, 1 } } } );
+        ins.components.push_back( { { { e.second.item, 1 } } } );
 
-        const requirement_id ins_id( std::string( "inline_vehins_base_" ) + part.id.str() );
+        const requirement_id ins_id( std::string( "inline_vehins_base_" ) + e.second.id.str() );
         requirement_data::save_requirement( ins, ins_id );
-        part.install_reqs.emplace_back( ins_id, 1 );
+        e.second.install_reqs.emplace_back( ins_id, 1 );
 
-        if( part.removal_moves < 0 ) {
-            part.removal_moves = part.install_moves / 2;
+        if( e.second.removal_moves < 0 ) {
+            e.second.removal_moves = e.second.install_moves / 2;
         }
+    }
+}
+
+void vpart_info::check()
+{
+    for( auto &vp : vpart_info_all ) {
+        auto &part = vp.second;
 
         for( auto &e : part.install_skills ) {
             if( !e.first.is_valid() ) {
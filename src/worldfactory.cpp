@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "background_save.h"
 #include "cata_utility.h"
 #include "catacharset.h"
 #include "char_validity_check.h"
@@ -1469,6 +1470,8 @@ static bool isForbidden( const std::string &candidate )
 
 void worldfactory::delete_world( const std::string &worldname, const bool delete_folder )
 {
+    // Files still being written would come back after they have been deleted.
+    background_save::wait();
     std::string worldpath = get_world( worldname )->folder_path();
     std::set<std::string> directory_paths;
 